@@ -0,0 +1,486 @@
+#include "BPlusTree.h"
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+const int MIN_INNER_KEYS = BPlusTree::INNER_KEYS / 2;
+const int MIN_LEAF_RECORDS = BPlusTree::LEAF_RECORDS / 2;
+// Far more than enough: with at least 16 children per inner node, 8 inner
+// levels already hold over four billion records.
+const int MAX_HEIGHT = 16;
+
+}
+
+BPlusTree::BPlusTree()
+    : innerPool(1024), leafPool(256), root(nullptr), height(0), recordCount(0) {}
+
+BPlusTree::~BPlusTree() {
+    clear();
+}
+
+int BPlusTree::childIndexFor(const Inner *node, int id) {
+    return int(upper_bound(node->keys, node->keys + node->count, id) - node->keys);
+}
+
+int BPlusTree::leafIndexFor(const Leaf *leaf, int id) {
+    return int(lower_bound(leaf->keys, leaf->keys + leaf->count, id) - leaf->keys);
+}
+
+void BPlusTree::insertIntoLeaf(Leaf *leaf, int pos, RBTree::Student&& student) {
+    move_backward(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+    move_backward(leaf->records + pos, leaf->records + leaf->count, leaf->records + leaf->count + 1);
+    leaf->keys[pos] = student.getId();
+    leaf->records[pos] = std::move(student);
+    leaf->count++;
+}
+
+void BPlusTree::removeFromLeaf(Leaf *leaf, int pos) {
+    move(leaf->keys + pos + 1, leaf->keys + leaf->count, leaf->keys + pos);
+    move(leaf->records + pos + 1, leaf->records + leaf->count, leaf->records + pos);
+    leaf->count--;
+    // Releases the strings of the vacated slot instead of keeping them alive.
+    leaf->records[leaf->count] = RBTree::Student();
+}
+
+// Removes keys[keyIndex] and the child to its right.
+void BPlusTree::removeChild(Inner *node, int keyIndex) {
+    move(node->keys + keyIndex + 1, node->keys + node->count, node->keys + keyIndex);
+    move(node->children + keyIndex + 2, node->children + node->count + 1, node->children + keyIndex + 1);
+    node->count--;
+}
+
+// Descends to the leaf that holds (or would hold) id. With path set, it
+// records the inner node and child index taken at every level.
+BPlusTree::Leaf *BPlusTree::findLeaf(int id, PathEntry *path) const {
+    void *node = root;
+    if (node == nullptr) {
+        return nullptr;
+    }
+    for (int level = 0; level < height; level++) {
+        Inner *inner = static_cast<Inner*>(node);
+        int index = childIndexFor(inner, id);
+        if (path != nullptr) {
+            path[level] = {inner, index};
+        }
+        node = inner->children[index];
+    }
+    return static_cast<Leaf*>(node);
+}
+
+bool BPlusTree::insert(int id, string name, string dept, double gpa) {
+    return insert(RBTree::Student(id, std::move(name), std::move(dept), gpa));
+}
+
+bool BPlusTree::insert(RBTree::Student&& student) {
+    if (!RBTree::isValidGpa(student.getGpa())) {
+        return false;
+    }
+    int id = student.getId();
+    if (root == nullptr) {
+        root = leafPool.create();
+        height = 0;
+    }
+
+    PathEntry path[MAX_HEIGHT];
+    Leaf *leaf = findLeaf(id, path);
+    int pos = leafIndexFor(leaf, id);
+    if (pos < leaf->count && leaf->keys[pos] == id) {
+        return false;
+    }
+    recordCount++;
+
+    if (leaf->count < LEAF_RECORDS) {
+        insertIntoLeaf(leaf, pos, std::move(student));
+        return true;
+    }
+
+    // Full leaf: move the upper half into a new right sibling first.
+    const int half = LEAF_RECORDS / 2;
+    Leaf *right = leafPool.create();
+    move(leaf->keys + half, leaf->keys + LEAF_RECORDS, right->keys);
+    move(leaf->records + half, leaf->records + LEAF_RECORDS, right->records);
+    for (int i = half; i < LEAF_RECORDS; i++) {
+        leaf->records[i] = RBTree::Student();
+    }
+    right->count = LEAF_RECORDS - half;
+    leaf->count = half;
+
+    right->next = leaf->next;
+    if (right->next != nullptr) {
+        right->next->prev = right;
+    }
+    right->prev = leaf;
+    leaf->next = right;
+
+    if (pos <= half) {
+        insertIntoLeaf(leaf, pos, std::move(student));
+    } else {
+        insertIntoLeaf(right, pos - half, std::move(student));
+    }
+    insertIntoParent(path, height, right->keys[0], right);
+    return true;
+}
+
+// Adds (separator, right) next to the child the descent took at path[depth-1],
+// splitting full inner nodes on the way up and growing a new root if the
+// split reaches the top.
+void BPlusTree::insertIntoParent(PathEntry *path, int depth, int separator, void *right) {
+    while (depth > 0) {
+        Inner *parent = path[depth - 1].node;
+        int index = path[depth - 1].childIndex;
+        if (parent->count < INNER_KEYS) {
+            move_backward(parent->keys + index, parent->keys + parent->count,
+                          parent->keys + parent->count + 1);
+            move_backward(parent->children + index + 1, parent->children + parent->count + 1,
+                          parent->children + parent->count + 2);
+            parent->keys[index] = separator;
+            parent->children[index + 1] = right;
+            parent->count++;
+            return;
+        }
+
+        int keys[INNER_KEYS + 1];
+        void *children[INNER_KEYS + 2];
+        copy(parent->keys, parent->keys + index, keys);
+        keys[index] = separator;
+        copy(parent->keys + index, parent->keys + INNER_KEYS, keys + index + 1);
+        copy(parent->children, parent->children + index + 1, children);
+        children[index + 1] = right;
+        copy(parent->children + index + 1, parent->children + INNER_KEYS + 1, children + index + 2);
+
+        // The middle key moves up; it is not kept in either half.
+        const int total = INNER_KEYS + 1;
+        const int mid = total / 2;
+        Inner *sibling = innerPool.create();
+        copy(keys, keys + mid, parent->keys);
+        copy(children, children + mid + 1, parent->children);
+        parent->count = mid;
+        copy(keys + mid + 1, keys + total, sibling->keys);
+        copy(children + mid + 1, children + total + 1, sibling->children);
+        sibling->count = total - mid - 1;
+
+        separator = keys[mid];
+        right = sibling;
+        depth--;
+    }
+
+    Inner *newRoot = innerPool.create();
+    newRoot->count = 1;
+    newRoot->keys[0] = separator;
+    newRoot->children[0] = root;
+    newRoot->children[1] = right;
+    root = newRoot;
+    height++;
+}
+
+bool BPlusTree::deleteNode(int id) {
+    PathEntry path[MAX_HEIGHT];
+    Leaf *leaf = findLeaf(id, path);
+    if (leaf == nullptr) {
+        return false;
+    }
+    int pos = leafIndexFor(leaf, id);
+    if (pos >= leaf->count || leaf->keys[pos] != id) {
+        return false;
+    }
+    removeFromLeaf(leaf, pos);
+    recordCount--;
+
+    if (height == 0) {
+        if (leaf->count == 0) {
+            leafPool.destroy(leaf);
+            root = nullptr;
+        }
+    } else if (leaf->count < MIN_LEAF_RECORDS) {
+        rebalanceLeaf(leaf, path, height);
+    }
+    return true;
+}
+
+// Refills an underfull leaf from a sibling under the same parent, or merges
+// it with one when neither can spare a record. Separators stay valid after
+// a plain delete (they only need to bound the keys, not match one), so
+// only borrowing and merging touch the parent.
+void BPlusTree::rebalanceLeaf(Leaf *leaf, PathEntry *path, int depth) {
+    Inner *parent = path[depth - 1].node;
+    int index = path[depth - 1].childIndex;
+    Leaf *left = index > 0 ? static_cast<Leaf*>(parent->children[index - 1]) : nullptr;
+    Leaf *right = index < parent->count ? static_cast<Leaf*>(parent->children[index + 1]) : nullptr;
+
+    if (left != nullptr && left->count > MIN_LEAF_RECORDS) {
+        int last = left->count - 1;
+        insertIntoLeaf(leaf, 0, std::move(left->records[last]));
+        removeFromLeaf(left, last);
+        parent->keys[index - 1] = leaf->keys[0];
+        return;
+    }
+    if (right != nullptr && right->count > MIN_LEAF_RECORDS) {
+        insertIntoLeaf(leaf, leaf->count, std::move(right->records[0]));
+        removeFromLeaf(right, 0);
+        parent->keys[index] = right->keys[0];
+        return;
+    }
+
+    if (left != nullptr) {
+        mergeLeaves(left, leaf);
+        removeChild(parent, index - 1);
+    } else {
+        mergeLeaves(leaf, right);
+        removeChild(parent, index);
+    }
+    rebalanceInner(parent, path, depth - 1);
+}
+
+void BPlusTree::mergeLeaves(Leaf *left, Leaf *right) {
+    move(right->keys, right->keys + right->count, left->keys + left->count);
+    move(right->records, right->records + right->count, left->records + left->count);
+    left->count += right->count;
+    left->next = right->next;
+    if (left->next != nullptr) {
+        left->next->prev = left;
+    }
+    leafPool.destroy(right);
+}
+
+// node is path[level].node. Same borrow-or-merge scheme as for leaves, except
+// that keys rotate through the parent's separator instead of being copied.
+void BPlusTree::rebalanceInner(Inner *node, PathEntry *path, int level) {
+    if (level == 0) {
+        if (node->count == 0) {
+            root = node->children[0];
+            height--;
+            innerPool.destroy(node);
+        }
+        return;
+    }
+    if (node->count >= MIN_INNER_KEYS) {
+        return;
+    }
+
+    Inner *parent = path[level - 1].node;
+    int index = path[level - 1].childIndex;
+    Inner *left = index > 0 ? static_cast<Inner*>(parent->children[index - 1]) : nullptr;
+    Inner *right = index < parent->count ? static_cast<Inner*>(parent->children[index + 1]) : nullptr;
+
+    if (left != nullptr && left->count > MIN_INNER_KEYS) {
+        move_backward(node->keys, node->keys + node->count, node->keys + node->count + 1);
+        move_backward(node->children, node->children + node->count + 1,
+                      node->children + node->count + 2);
+        node->keys[0] = parent->keys[index - 1];
+        node->children[0] = left->children[left->count];
+        node->count++;
+        parent->keys[index - 1] = left->keys[left->count - 1];
+        left->count--;
+        return;
+    }
+    if (right != nullptr && right->count > MIN_INNER_KEYS) {
+        node->keys[node->count] = parent->keys[index];
+        node->children[node->count + 1] = right->children[0];
+        node->count++;
+        parent->keys[index] = right->keys[0];
+        move(right->keys + 1, right->keys + right->count, right->keys);
+        move(right->children + 1, right->children + right->count + 1, right->children);
+        right->count--;
+        return;
+    }
+
+    if (left != nullptr) {
+        mergeInner(left, parent->keys[index - 1], node);
+        removeChild(parent, index - 1);
+    } else {
+        mergeInner(node, parent->keys[index], right);
+        removeChild(parent, index);
+    }
+    rebalanceInner(parent, path, level - 1);
+}
+
+void BPlusTree::mergeInner(Inner *left, int separator, Inner *right) {
+    left->keys[left->count] = separator;
+    copy(right->keys, right->keys + right->count, left->keys + left->count + 1);
+    copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+    left->count += 1 + right->count;
+    innerPool.destroy(right);
+}
+
+const RBTree::Student *BPlusTree::find(int id) const {
+    const Leaf *leaf = findLeaf(id, nullptr);
+    if (leaf == nullptr) {
+        return nullptr;
+    }
+    int pos = leafIndexFor(leaf, id);
+    return pos < leaf->count && leaf->keys[pos] == id ? &leaf->records[pos] : nullptr;
+}
+
+void BPlusTree::destroySubtree(void *node, int level) {
+    if (level == height) {
+        leafPool.destroy(static_cast<Leaf*>(node));
+        return;
+    }
+    Inner *inner = static_cast<Inner*>(node);
+    for (int i = 0; i <= inner->count; i++) {
+        destroySubtree(inner->children[i], level + 1);
+    }
+    innerPool.destroy(inner);
+}
+
+void BPlusTree::clear() {
+    if (root != nullptr) {
+        destroySubtree(root, 0);
+    }
+    innerPool.releaseAll();
+    leafPool.releaseAll();
+    root = nullptr;
+    height = 0;
+    recordCount = 0;
+}
+
+size_t BPlusTree::bulkLoad(vector<RBTree::Student> students, vector<int> *duplicates, vector<int> *invalid) {
+    auto byId = [](const RBTree::Student& a, const RBTree::Student& b) { return a.getId() < b.getId(); };
+    if (!is_sorted(students.begin(), students.end(), byId)) {
+        stable_sort(students.begin(), students.end(), byId);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < students.size(); i++) {
+        if (!RBTree::isValidGpa(students[i].getGpa())) {
+            if (invalid != nullptr) {
+                invalid->push_back(students[i].getId());
+            }
+            continue;
+        }
+        if (kept > 0 && students[kept - 1].getId() == students[i].getId()) {
+            if (duplicates != nullptr) {
+                duplicates->push_back(students[i].getId());
+            }
+            continue;
+        }
+        if (kept != i) {
+            students[kept] = std::move(students[i]);
+        }
+        kept++;
+    }
+
+    clear();
+    if (kept == 0) {
+        return 0;
+    }
+
+    // Spreading each level evenly over ceil(n / capacity) nodes keeps every
+    // node at least half full, so no later insert or delete sees an
+    // underfull node it did not create.
+    vector<pair<void*, int>> level;     // (node, smallest key below it)
+    size_t leaves = (kept + LEAF_RECORDS - 1) / LEAF_RECORDS;
+    level.reserve(leaves);
+    Leaf *previous = nullptr;
+    size_t next = 0;
+    for (size_t i = 0; i < leaves; i++) {
+        int take = int(kept / leaves + (i < kept % leaves ? 1 : 0));
+        Leaf *leaf = leafPool.create();
+        for (int j = 0; j < take; j++, next++) {
+            leaf->keys[j] = students[next].getId();
+            leaf->records[j] = std::move(students[next]);
+        }
+        leaf->count = take;
+        leaf->prev = previous;
+        if (previous != nullptr) {
+            previous->next = leaf;
+        }
+        previous = leaf;
+        level.emplace_back(leaf, leaf->keys[0]);
+    }
+
+    height = 0;
+    while (level.size() > 1) {
+        size_t children = level.size();
+        size_t nodes = (children + INNER_KEYS) / (INNER_KEYS + 1);
+        vector<pair<void*, int>> parents;
+        parents.reserve(nodes);
+        next = 0;
+        for (size_t i = 0; i < nodes; i++) {
+            int take = int(children / nodes + (i < children % nodes ? 1 : 0));
+            Inner *inner = innerPool.create();
+            for (int j = 0; j < take; j++) {
+                inner->children[j] = level[next + j].first;
+                if (j > 0) {
+                    inner->keys[j - 1] = level[next + j].second;
+                }
+            }
+            inner->count = take - 1;
+            parents.emplace_back(inner, level[next].second);
+            next += take;
+        }
+        level.swap(parents);
+        height++;
+    }
+    root = level[0].first;
+    recordCount = kept;
+    return kept;
+}
+
+size_t BPlusTree::size() const {
+    return recordCount;
+}
+
+int BPlusTree::getHeight() const {
+    return height;
+}
+
+size_t BPlusTree::bytesReserved() const {
+    return innerPool.bytesReserved() + leafPool.bytesReserved();
+}
+
+// Returns the number of records below node, or -1 if anything is off.
+// previous is the last leaf seen so far, to check the sibling links.
+long long BPlusTree::validateHelper(const void *node, int level, long long lo, long long hi,
+                                    const Leaf *&previous) const {
+    bool isRoot = level == 0;
+    if (level == height) {
+        const Leaf *leaf = static_cast<const Leaf*>(node);
+        if (leaf->count < (isRoot ? 1 : MIN_LEAF_RECORDS) || leaf->count > LEAF_RECORDS) {
+            return -1;
+        }
+        for (int i = 0; i < leaf->count; i++) {
+            if (leaf->keys[i] < lo || leaf->keys[i] > hi || leaf->keys[i] != leaf->records[i].getId()
+                || (i > 0 && leaf->keys[i] <= leaf->keys[i - 1])) {
+                return -1;
+            }
+        }
+        if (leaf->prev != previous || (previous != nullptr && previous->next != leaf)) {
+            return -1;
+        }
+        previous = leaf;
+        return leaf->count;
+    }
+
+    const Inner *inner = static_cast<const Inner*>(node);
+    if (inner->count < (isRoot ? 1 : MIN_INNER_KEYS) || inner->count > INNER_KEYS) {
+        return -1;
+    }
+    long long total = 0;
+    for (int i = 0; i <= inner->count; i++) {
+        long long childLo = i == 0 ? lo : inner->keys[i - 1];
+        long long childHi = i == inner->count ? hi : inner->keys[i] - 1LL;
+        if (childLo > childHi) {
+            return -1;
+        }
+        long long count = validateHelper(inner->children[i], level + 1, childLo, childHi, previous);
+        if (count < 0) {
+            return -1;
+        }
+        total += count;
+    }
+    return total;
+}
+
+bool BPlusTree::validate() const {
+    if (root == nullptr) {
+        return recordCount == 0 && height == 0;
+    }
+    const Leaf *previous = nullptr;
+    long long count = validateHelper(root, 0, LLONG_MIN, LLONG_MAX, previous);
+    return count >= 0 && size_t(count) == recordCount && previous->next == nullptr;
+}
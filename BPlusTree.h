@@ -0,0 +1,115 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "NodePool.h"
+#include "RBTree.h"
+
+// B+-tree keyed by student ID, an alternative to RBTree for large rosters.
+//
+// Inner nodes hold only keys and child pointers, aligned to cache lines, so
+// a lookup touches a few lines per level and the tree is about four levels
+// deep at 10M students. Records live only in the leaves, which are linked
+// both ways for range scans. Separator keys[i] is the smallest key that
+// may appear under children[i + 1].
+class BPlusTree {
+public:
+    static const int INNER_KEYS = 31;       // children per inner node: 16..32
+    static const int LEAF_RECORDS = 32;     // records per leaf: 16..32
+
+private:
+    struct alignas(64) Inner {
+        int count;                          // number of keys
+        int keys[INNER_KEYS];
+        void *children[INNER_KEYS + 1];     // Inner* or, on the last level, Leaf*
+    };
+
+    struct alignas(64) Leaf {
+        int count;
+        int keys[LEAF_RECORDS];             // kept apart from the records for the search
+        Leaf *prev;
+        Leaf *next;
+        RBTree::Student records[LEAF_RECORDS];
+    };
+
+    // One step of a root-to-leaf descent, used to walk back up on a split
+    // or underflow.
+    struct PathEntry {
+        Inner *node;
+        int childIndex;
+    };
+
+    NodePool<Inner> innerPool;
+    NodePool<Leaf> leafPool;
+    void *root;                             // nullptr when empty
+    int height;                             // inner levels above the leaves
+    std::size_t recordCount;
+
+    static int childIndexFor(const Inner *node, int id);
+    static int leafIndexFor(const Leaf *leaf, int id);
+    static void insertIntoLeaf(Leaf *leaf, int pos, RBTree::Student&& student);
+    static void removeFromLeaf(Leaf *leaf, int pos);
+    static void removeChild(Inner *node, int keyIndex);
+    Leaf *findLeaf(int id, PathEntry *path) const;
+    void insertIntoParent(PathEntry *path, int depth, int separator, void *right);
+    void rebalanceLeaf(Leaf *leaf, PathEntry *path, int depth);
+    void rebalanceInner(Inner *node, PathEntry *path, int level);
+    void mergeLeaves(Leaf *left, Leaf *right);
+    void mergeInner(Inner *left, int separator, Inner *right);
+    void destroySubtree(void *node, int level);
+    long long validateHelper(const void *node, int level, long long lo, long long hi,
+                             const Leaf *&previous) const;
+
+public:
+    BPlusTree();
+    ~BPlusTree();
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Same contract as RBTree: false on a duplicate ID / missing ID, and
+    // insert rejects a GPA RBTree::isValidGpa rejects.
+    bool insert(int id, std::string name, std::string dept, double gpa);
+    bool insert(RBTree::Student&& student);
+    bool deleteNode(int id);
+    const RBTree::Student *find(int id) const;
+    void clear();
+
+    // Sorts if needed, keeps the first of repeated IDs (reporting the rest),
+    // drops and reports invalid GPAs as RBTree::bulkLoad does, and builds
+    // the tree level by level with evenly filled nodes.
+    std::size_t bulkLoad(std::vector<RBTree::Student> students, std::vector<int> *duplicates = nullptr,
+                         std::vector<int> *invalid = nullptr);
+
+    // Calls visit(const Student&) for each student in [minID, maxID], in ID
+    // order, following the leaf chain.
+    template <typename Visitor>
+    void forEachInRange(int minID, int maxID, Visitor visit) const {
+        if (minID > maxID) {
+            return;
+        }
+        const Leaf *leaf = findLeaf(minID, nullptr);
+        if (leaf == nullptr) {
+            return;
+        }
+        int i = leafIndexFor(leaf, minID);
+        for (; leaf != nullptr; leaf = leaf->next, i = 0) {
+            for (; i < leaf->count; i++) {
+                if (leaf->keys[i] > maxID) {
+                    return;
+                }
+                visit(leaf->records[i]);
+            }
+        }
+    }
+
+    std::size_t size() const;
+    int getHeight() const;
+    std::size_t bytesReserved() const;
+    // Checks key order, node fill, uniform depth and the leaf chain.
+    bool validate() const;
+};
+
+#endif
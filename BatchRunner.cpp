@@ -0,0 +1,332 @@
+#include "BatchRunner.h"
+#include "Metrics.h"
+#include <charconv>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const size_t MAX_ARGS = 6;
+
+// Splits a command line on blanks; "double quoted" arguments may contain
+// blanks and \" for a literal quote.
+size_t tokenize(string_view line, string_view *args, string *quoted) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < MAX_ARGS) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) {
+            pos++;
+        }
+        if (pos >= line.size()) {
+            break;
+        }
+        if (line[pos] == '"') {
+            string& text = quoted[count];
+            text.clear();
+            pos++;
+            while (pos < line.size() && line[pos] != '"') {
+                if (line[pos] == '\\' && pos + 1 < line.size()) {
+                    pos++;
+                }
+                text += line[pos++];
+            }
+            pos++;
+            args[count++] = text;
+        } else {
+            size_t start = pos;
+            while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '\r') {
+                pos++;
+            }
+            args[count++] = line.substr(start, pos - start);
+        }
+    }
+    return count;
+}
+
+template <typename T>
+bool parseNumber(string_view text, T& value) {
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && result.ec == errc() && result.ptr == text.data() + text.size();
+}
+
+}
+
+BatchRunner::BatchRunner(RBTree& t, BufferedWriter& output, DurableStore *store)
+    : tree(t), durable(store), out(output), lineNumber(0), commands(0), errors(0),
+      columnsStale(true) {}
+
+void BatchRunner::run(FILE *input) {
+    vector<char> chunk(1 << 20);
+    string carry;
+
+    size_t bytes;
+    while ((bytes = fread(chunk.data(), 1, chunk.size(), input)) > 0) {
+        const char *pos = chunk.data();
+        const char *end = chunk.data() + bytes;
+        while (pos < end) {
+            const char *newline = static_cast<const char*>(memchr(pos, '\n', size_t(end - pos)));
+            if (newline == nullptr) {
+                carry.append(pos, end);
+                break;
+            }
+            if (carry.empty()) {
+                execute(string_view(pos, size_t(newline - pos)));
+            } else {
+                carry.append(pos, newline);
+                execute(carry);
+                carry.clear();
+            }
+            pos = newline + 1;
+        }
+    }
+    if (!carry.empty()) {
+        execute(carry);
+    }
+    if (durable != nullptr) {
+        durable->sync();
+    }
+    out.flush();
+}
+
+void BatchRunner::execute(string_view line) {
+    lineNumber++;
+    string_view args[MAX_ARGS];
+    string quoted[MAX_ARGS];
+    size_t count = tokenize(line, args, quoted);
+    if (count == 0 || (!args[0].empty() && args[0][0] == '#')) {
+        return;
+    }
+    commands++;
+
+    string_view command = args[0];
+    int id;
+    if (command == "add") {
+        double gpa;
+        if (count != 5 || !parseNumber(args[1], id) || !parseNumber(args[4], gpa)) {
+            writeError("usage: add <id> <name> <dept> <gpa>");
+            return;
+        }
+        if (!RBTree::isValidGpa(gpa)) {
+            writeError("invalid gpa");
+            return;
+        }
+        bool added = durable != nullptr ? durable->insert(id, args[2], args[3], gpa)
+                                        : tree.insert(id, args[2], args[3], gpa);
+        if (added) {
+            columnsStale = true;
+            out.write(string_view("OK\n"));
+        } else {
+            out.write(string_view("DUPLICATE\t")).write(static_cast<long long>(id)).write('\n');
+        }
+    } else if (command == "search") {
+        if (count != 2 || !parseNumber(args[1], id)) {
+            writeError("usage: search <id>");
+            return;
+        }
+        RBTree::const_iterator it = tree.find(id);
+        if (it != tree.end()) {
+            writeStudent(*it);
+        } else {
+            out.write(string_view("NOT_FOUND\t")).write(static_cast<long long>(id)).write('\n');
+        }
+    } else if (command == "delete") {
+        if (count != 2 || !parseNumber(args[1], id)) {
+            writeError("usage: delete <id>");
+            return;
+        }
+        bool removed = durable != nullptr ? durable->deleteNode(id) : tree.deleteNode(id);
+        if (removed) {
+            columnsStale = true;
+            out.write(string_view("OK\n"));
+        } else {
+            out.write(string_view("NOT_FOUND\t")).write(static_cast<long long>(id)).write('\n');
+        }
+    } else if (command == "range" || command == "dump") {
+        int minID, maxID;
+        RBTree::Range rows(tree.begin(), tree.end());
+        if (command == "range") {
+            if (count != 3 || !parseNumber(args[1], minID) || !parseNumber(args[2], maxID)) {
+                writeError("usage: range <minID> <maxID>");
+                return;
+            }
+            rows = tree.range(minID, maxID);
+        } else if (count != 1) {
+            writeError("usage: dump");
+            return;
+        }
+        long long rowCount = 0;
+        for (RBTree::StudentView student : rows) {
+            writeStudent(student);
+            rowCount++;
+        }
+        out.write(string_view("END\t")).write(rowCount).write('\n');
+    } else if (command == "dept") {
+        if (count != 2) {
+            writeError("usage: dept <department>");
+            return;
+        }
+        tree.forEachInDepartment(args[1], [this](const RBTree::StudentView& student) {
+            writeStudent(student);
+        });
+        out.write(string_view("END\t")).write(static_cast<long long>(tree.countInDepartment(args[1]))).write('\n');
+    } else if (command == "count") {
+        int minID, maxID;
+        if (count != 3 || !parseNumber(args[1], minID) || !parseNumber(args[2], maxID)) {
+            writeError("usage: count <minID> <maxID>");
+            return;
+        }
+        out.write(static_cast<long long>(tree.countRange(minID, maxID))).write('\n');
+    } else if (command == "stats") {
+        int minID, maxID;
+        if (count != 3 || !parseNumber(args[1], minID) || !parseNumber(args[2], maxID)) {
+            writeError("usage: stats <minID> <maxID>");
+            return;
+        }
+        RBTree::GpaStats stats = tree.rangeStats(minID, maxID);
+        out.write(static_cast<long long>(stats.count));
+        if (stats.count > 0) {
+            out.write('\t').writeFixed(stats.mean(), 3)
+               .write('\t').writeFixed(stats.stddev(), 3)
+               .write('\t').writeFixed(stats.min, 2)
+               .write('\t').writeFixed(stats.max, 2);
+        }
+        out.write('\n');
+    } else if (command == "gpa") {
+        double gpa;
+        if (count != 3 || !parseNumber(args[1], id) || !parseNumber(args[2], gpa)) {
+            writeError("usage: gpa <id> <gpa>");
+            return;
+        }
+        if (!RBTree::isValidGpa(gpa)) {
+            writeError("invalid gpa");
+            return;
+        }
+        bool updated = durable != nullptr ? durable->updateGpa(id, gpa) : tree.updateGpa(id, gpa);
+        if (updated) {
+            columnsStale = true;
+            out.write(string_view("OK\n"));
+        } else {
+            out.write(string_view("NOT_FOUND\t")).write(static_cast<long long>(id)).write('\n');
+        }
+    } else if (command == "top" || command == "gparange") {
+        vector<RBTree::StudentView> rows;
+        if (command == "top") {
+            long long k;
+            if (count != 2 || !parseNumber(args[1], k) || k < 0) {
+                writeError("usage: top <k>");
+                return;
+            }
+            rows = tree.topK(static_cast<size_t>(k));
+        } else {
+            double lo, hi;
+            if (count != 3 || !parseNumber(args[1], lo) || !parseNumber(args[2], hi)) {
+                writeError("usage: gparange <lo> <hi>");
+                return;
+            }
+            rows = tree.gpaRange(lo, hi);
+        }
+        for (const RBTree::StudentView& student : rows) {
+            writeStudent(student);
+        }
+        out.write(string_view("END\t")).write(static_cast<long long>(rows.size())).write('\n');
+    } else if (command == "prefix" || command == "contains") {
+        if (count != 2) {
+            writeError(command == "prefix" ? "usage: prefix <text>" : "usage: contains <text>");
+            return;
+        }
+        vector<RBTree::StudentView> rows = command == "prefix" ? tree.searchNamePrefix(args[1])
+                                                               : tree.searchNameContaining(args[1]);
+        for (const RBTree::StudentView& student : rows) {
+            writeStudent(student);
+        }
+        out.write(string_view("END\t")).write(static_cast<long long>(rows.size())).write('\n');
+    } else if (command == "filter") {
+        ColumnSnapshot::Filter filter;
+        if (count != 4 || !parseNumber(args[2], filter.minGpa) || !parseNumber(args[3], filter.maxGpa)) {
+            writeError("usage: filter <dept|*> <lo> <hi>");
+            return;
+        }
+        filter.anyDepartment = args[1] == "*";
+        filter.deptCode = filter.anyDepartment ? DepartmentIndex::NO_DEPARTMENT
+                                               : tree.getDepartmentIndex().findCode(args[1]);
+        if (columnsStale) {
+            columns.rebuild(tree);
+            columnsStale = false;
+        }
+        vector<int> ids = columns.matchIds(filter);
+        for (int match : ids) {
+            writeStudent(*tree.find(match));
+        }
+        out.write(string_view("END\t")).write(static_cast<long long>(ids.size())).write('\n');
+    } else if (command == "percentile") {
+        double p;
+        if (count != 2 || !parseNumber(args[1], p) || p < 0.0 || p > 100.0) {
+            writeError("usage: percentile <0-100>");
+            return;
+        }
+        out.writeFixed(tree.percentile(p), 2).write('\n');
+    } else if (command == "page") {
+        long long offset, limit;
+        if (count != 3 || !parseNumber(args[1], offset) || !parseNumber(args[2], limit)
+            || offset < 0 || limit < 0) {
+            writeError("usage: page <offset> <limit>");
+            return;
+        }
+        long long rowCount = 0;
+        for (RBTree::const_iterator it = tree.select(static_cast<size_t>(offset));
+             it != tree.end() && rowCount < limit; ++it) {
+            writeStudent(*it);
+            rowCount++;
+        }
+        out.write(string_view("END\t")).write(rowCount).write('\n');
+    } else if (command == "size") {
+        if (count != 1) {
+            writeError("usage: size");
+            return;
+        }
+        out.write(static_cast<long long>(tree.size())).write('\n');
+    } else if (command == "memory") {
+        if (count != 1) {
+            writeError("usage: memory");
+            return;
+        }
+        RBTree::MemoryReport report = tree.memoryUsage();
+        out.write(static_cast<long long>(report.nodeBytes))
+           .write('\t').write(static_cast<long long>(report.recordBytes))
+           .write('\t').write(static_cast<long long>(report.nameBytes))
+           .write('\t').write(static_cast<long long>(report.indexBytes))
+           .write('\t').write(static_cast<long long>(report.total()))
+           .write('\t').writeFixed(report.bytesPerStudent(), 1).write('\n');
+    } else if (command == "metrics") {
+        if (count != 1) {
+            writeError("usage: metrics");
+            return;
+        }
+        out.write(string_view(Metrics::formatJson(tree))).write('\n');
+    } else {
+        writeError("unknown command");
+    }
+}
+
+void BatchRunner::writeStudent(const RBTree::StudentView& student) {
+    out.write(static_cast<long long>(student.getId())).write('\t')
+       .write(student.getName()).write('\t')
+       .write(student.getDept()).write('\t')
+       .writeFixed(student.getGpa(), 2).write('\n');
+}
+
+void BatchRunner::writeError(string_view message) {
+    errors++;
+    out.write(string_view("ERROR\t")).write(static_cast<long long>(lineNumber)).write('\t')
+       .write(message).write('\n');
+}
+
+size_t BatchRunner::getCommandCount() const {
+    return commands;
+}
+
+size_t BatchRunner::getErrorCount() const {
+    return errors;
+}
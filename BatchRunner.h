@@ -0,0 +1,64 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "BufferedWriter.h"
+#include "ColumnSnapshot.h"
+#include "DurableStore.h"
+#include "RBTree.h"
+
+// Executes newline-separated commands without prompts:
+//
+//   add <id> <name> <dept> <gpa>     -> OK | DUPLICATE <id>
+//   search <id>                      -> <student row> | NOT_FOUND <id>
+//   delete <id>                      -> OK | NOT_FOUND <id>
+//   range <minID> <maxID>            -> <student row>... END <count>
+//   dump                             -> <student row>... END <count>
+//   dept <dept>                      -> <student row>... END <count>
+//   count <minID> <maxID>            -> <count>
+//   stats <minID> <maxID>            -> <count> [<mean> <stddev> <min> <max>]
+//   gpa <id> <gpa>                   -> OK | NOT_FOUND <id>
+//   top <k>                          -> <student row>... END <count>
+//   gparange <lo> <hi>               -> <student row>... END <count>
+//   percentile <p>                   -> <gpa>
+//   prefix <text>                    -> <student row>... END <count>
+//   contains <text>                  -> <student row>... END <count>
+//   filter <dept|*> <lo> <hi>        -> <student row>... END <count>
+//   page <offset> <limit>            -> <student row>... END <count>
+//   size                             -> <count>
+//   memory                           -> <nodes> <records> <names> <indexes> <total> <bytes/student>
+//   metrics                          -> <JSON counters and latencies>
+//
+// Arguments are separated by blanks; wrap names with spaces in double
+// quotes. Blank lines and lines starting with # are skipped. Every output
+// field is tab-separated, a student row is "id name dept gpa", and a bad
+// command (including extra arguments) yields "ERROR <line> <message>".
+class BatchRunner {
+private:
+    RBTree& tree;
+    DurableStore *durable;
+    BufferedWriter& out;
+    std::size_t lineNumber;
+    std::size_t commands;
+    std::size_t errors;
+    ColumnSnapshot columns;         // for filter; rebuilt after changes
+    bool columnsStale;
+
+    void execute(std::string_view line);
+    void writeStudent(const RBTree::StudentView& student);
+    void writeError(std::string_view message);
+
+public:
+    // With a DurableStore, add/delete go through its write-ahead log.
+    BatchRunner(RBTree& t, BufferedWriter& output, DurableStore *store = nullptr);
+
+    void run(std::FILE *input);
+
+    std::size_t getCommandCount() const;
+    std::size_t getErrorCount() const;
+};
+
+#endif
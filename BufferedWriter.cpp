@@ -0,0 +1,59 @@
+#include "BufferedWriter.h"
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+BufferedWriter::BufferedWriter(FILE *file, size_t capacity)
+    : out(file), buffer(capacity < 64 ? 64 : capacity), used(0) {}
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+}
+
+BufferedWriter& BufferedWriter::write(string_view text) {
+    if (text.size() > buffer.size() - used) {
+        flush();
+        if (text.size() > buffer.size()) {
+            fwrite(text.data(), 1, text.size(), out);
+            return *this;
+        }
+    }
+    memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::write(char c) {
+    if (used == buffer.size()) {
+        flush();
+    }
+    buffer[used++] = c;
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::write(long long value) {
+    if (buffer.size() - used < 24) {
+        flush();
+    }
+    to_chars_result result = to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = size_t(result.ptr - buffer.data());
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::writeFixed(double value, int precision) {
+    char text[64];
+    to_chars_result result = to_chars(text, text + sizeof(text), value, chars_format::fixed, precision);
+    if (result.ec != errc()) {
+        return write(string_view("nan"));
+    }
+    return write(string_view(text, size_t(result.ptr - text)));
+}
+
+void BufferedWriter::flush() {
+    if (used > 0) {
+        fwrite(buffer.data(), 1, used, out);
+        used = 0;
+    }
+    fflush(out);
+}
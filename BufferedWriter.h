@@ -0,0 +1,32 @@
+#ifndef BUFFEREDWRITER_H
+#define BUFFEREDWRITER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+// Minimal output buffer for machine-readable results: numbers are formatted
+// with std::to_chars and nothing reaches the FILE until the buffer fills or
+// flush() is called, so there is no per-line flushing like endl.
+class BufferedWriter {
+private:
+    std::FILE *out;
+    std::vector<char> buffer;
+    std::size_t used;
+
+public:
+    explicit BufferedWriter(std::FILE *file, std::size_t capacity = 1 << 16);
+    ~BufferedWriter();
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    BufferedWriter& write(std::string_view text);
+    BufferedWriter& write(char c);
+    BufferedWriter& write(long long value);
+    BufferedWriter& writeFixed(double value, int precision);
+
+    void flush();
+};
+
+#endif
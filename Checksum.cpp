@@ -0,0 +1,53 @@
+#include "Checksum.h"
+#include <array>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// Slicing-by-8 tables: table[0] is the classic byte-wise table, table[k]
+// advances a byte that sits k positions further back in the word.
+array<array<uint32_t, 256>, 8> makeTables() {
+    array<array<uint32_t, 256>, 8> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+        }
+    }
+    return table;
+}
+
+const array<array<uint32_t, 256>, 8> crcTable = makeTables();
+
+}
+
+uint32_t crc32(const void *data, size_t length, uint32_t seed) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    uint32_t crc = ~seed;
+
+    // Eight bytes per step; the word loads assume a little-endian host.
+    while (length >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, bytes, 4);
+        memcpy(&hi, bytes + 4, 4);
+        lo ^= crc;
+        crc = crcTable[7][lo & 0xFF] ^ crcTable[6][(lo >> 8) & 0xFF] ^
+              crcTable[5][(lo >> 16) & 0xFF] ^ crcTable[4][lo >> 24] ^
+              crcTable[3][hi & 0xFF] ^ crcTable[2][(hi >> 8) & 0xFF] ^
+              crcTable[1][(hi >> 16) & 0xFF] ^ crcTable[0][hi >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ crcTable[0][(crc ^ *bytes++) & 0xFF];
+    }
+    return ~crc;
+}
@@ -0,0 +1,11 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3 polynomial, same values as zlib's crc32()).
+// Pass the previous result as seed to checksum data in several pieces.
+uint32_t crc32(const void *data, std::size_t length, uint32_t seed = 0);
+
+#endif
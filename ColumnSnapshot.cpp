@@ -0,0 +1,220 @@
+#include "ColumnSnapshot.h"
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define COLUMN_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace {
+
+inline bool matches(const ColumnSnapshot::Filter& filter, double gpa, uint16_t dept) {
+    return gpa >= filter.minGpa && gpa <= filter.maxGpa
+        && (filter.anyDepartment || dept == filter.deptCode);
+}
+
+// Every kernel fills wordCount complete 64-row words; matchBitmap does the
+// rows after the last complete word with matches().
+void scanScalar(const double *gpas, const uint16_t *depts, size_t wordCount,
+                const ColumnSnapshot::Filter& filter, uint64_t *out) {
+    for (size_t w = 0; w < wordCount; w++) {
+        uint64_t word = 0;
+        for (size_t bit = 0; bit < 64; bit++) {
+            size_t row = w * 64 + bit;
+            word |= uint64_t(matches(filter, gpas[row], depts[row])) << bit;
+        }
+        out[w] = word;
+    }
+}
+
+#ifdef COLUMN_SCAN_X86
+
+// Compares eight department codes at once; bit i is set when row i matches.
+inline unsigned deptMask8(const uint16_t *depts, __m128i code) {
+    __m128i eq = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(depts)), code);
+    return unsigned(_mm_movemask_epi8(_mm_packs_epi16(eq, _mm_setzero_si128())));
+}
+
+void scanSse2(const double *gpas, const uint16_t *depts, size_t wordCount,
+              const ColumnSnapshot::Filter& filter, uint64_t *out) {
+    const __m128d lo = _mm_set1_pd(filter.minGpa);
+    const __m128d hi = _mm_set1_pd(filter.maxGpa);
+    const __m128i code = _mm_set1_epi16(static_cast<short>(filter.deptCode));
+    for (size_t w = 0; w < wordCount; w++) {
+        uint64_t word = 0;
+        for (size_t block = 0; block < 8; block++) {
+            size_t row = w * 64 + block * 8;
+            unsigned gpaMask = 0;
+            for (size_t pair = 0; pair < 4; pair++) {
+                __m128d g = _mm_loadu_pd(gpas + row + pair * 2);
+                __m128d in = _mm_and_pd(_mm_cmpge_pd(g, lo), _mm_cmple_pd(g, hi));
+                gpaMask |= unsigned(_mm_movemask_pd(in)) << (pair * 2);
+            }
+            unsigned deptMask = filter.anyDepartment ? 0xFF : deptMask8(depts + row, code);
+            word |= uint64_t(gpaMask & deptMask) << (block * 8);
+        }
+        out[w] = word;
+    }
+}
+
+AVX2_TARGET void scanAvx2(const double *gpas, const uint16_t *depts, size_t wordCount,
+                          const ColumnSnapshot::Filter& filter, uint64_t *out) {
+    const __m256d lo = _mm256_set1_pd(filter.minGpa);
+    const __m256d hi = _mm256_set1_pd(filter.maxGpa);
+    const __m128i code = _mm_set1_epi16(static_cast<short>(filter.deptCode));
+    for (size_t w = 0; w < wordCount; w++) {
+        uint64_t word = 0;
+        for (size_t block = 0; block < 8; block++) {
+            size_t row = w * 64 + block * 8;
+            __m256d g0 = _mm256_loadu_pd(gpas + row);
+            __m256d g1 = _mm256_loadu_pd(gpas + row + 4);
+            __m256d in0 = _mm256_and_pd(_mm256_cmp_pd(g0, lo, _CMP_GE_OQ), _mm256_cmp_pd(g0, hi, _CMP_LE_OQ));
+            __m256d in1 = _mm256_and_pd(_mm256_cmp_pd(g1, lo, _CMP_GE_OQ), _mm256_cmp_pd(g1, hi, _CMP_LE_OQ));
+            unsigned gpaMask = unsigned(_mm256_movemask_pd(in0)) | (unsigned(_mm256_movemask_pd(in1)) << 4);
+            unsigned deptMask = filter.anyDepartment ? 0xFF : deptMask8(depts + row, code);
+            word |= uint64_t(gpaMask & deptMask) << (block * 8);
+        }
+        out[w] = word;
+    }
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osSavesYmm = (regs[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(regs, 7, 0);
+    return osSavesYmm && (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+}
+
+ColumnSnapshot::ColumnSnapshot() {}
+
+ColumnSnapshot::ColumnSnapshot(const RBTree& tree) {
+    rebuild(tree);
+}
+
+void ColumnSnapshot::rebuild(const RBTree& tree) {
+    ids.clear();
+    gpas.clear();
+    deptCodes.clear();
+    ids.reserve(tree.size());
+    gpas.reserve(tree.size());
+    deptCodes.reserve(tree.size());
+    for (RBTree::StudentView student : tree) {
+        ids.push_back(student.getId());
+        gpas.push_back(student.getGpa());
+        deptCodes.push_back(student.getDeptCode());
+    }
+}
+
+size_t ColumnSnapshot::size() const {
+    return ids.size();
+}
+
+int ColumnSnapshot::getId(size_t row) const {
+    return ids[row];
+}
+
+vector<uint64_t> ColumnSnapshot::matchBitmap(const Filter& filter) const {
+    return matchBitmap(filter, bestKernel());
+}
+
+// Falls back to the scalar kernel when the requested one is not available.
+vector<uint64_t> ColumnSnapshot::matchBitmap(const Filter& filter, ScanKernel kernel) const {
+    size_t rows = ids.size();
+    size_t fullWords = rows / 64;
+    vector<uint64_t> bitmap((rows + 63) / 64, 0);
+    if (!kernelSupported(kernel)) {
+        kernel = SCAN_SCALAR;
+    }
+
+    switch (kernel) {
+#ifdef COLUMN_SCAN_X86
+    case SCAN_AVX2:
+        scanAvx2(gpas.data(), deptCodes.data(), fullWords, filter, bitmap.data());
+        break;
+    case SCAN_SSE2:
+        scanSse2(gpas.data(), deptCodes.data(), fullWords, filter, bitmap.data());
+        break;
+#endif
+    default:
+        scanScalar(gpas.data(), deptCodes.data(), fullWords, filter, bitmap.data());
+        break;
+    }
+
+    for (size_t row = fullWords * 64; row < rows; row++) {
+        if (matches(filter, gpas[row], deptCodes[row])) {
+            bitmap[row / 64] |= uint64_t(1) << (row % 64);
+        }
+    }
+    return bitmap;
+}
+
+vector<int> ColumnSnapshot::matchIds(const Filter& filter) const {
+    vector<int> result;
+    vector<uint64_t> bitmap = matchBitmap(filter);
+    for (size_t w = 0; w < bitmap.size(); w++) {
+        for (uint64_t word = bitmap[w]; word != 0; word &= word - 1) {
+            result.push_back(ids[w * 64 + size_t(countr_zero(word))]);
+        }
+    }
+    return result;
+}
+
+size_t ColumnSnapshot::countMatches(const Filter& filter) const {
+    size_t count = 0;
+    for (uint64_t word : matchBitmap(filter)) {
+        count += size_t(popcount(word));
+    }
+    return count;
+}
+
+ScanKernel ColumnSnapshot::bestKernel() {
+    static const ScanKernel best = kernelSupported(SCAN_AVX2) ? SCAN_AVX2
+                                 : kernelSupported(SCAN_SSE2) ? SCAN_SSE2
+                                 : SCAN_SCALAR;
+    return best;
+}
+
+bool ColumnSnapshot::kernelSupported(ScanKernel kernel) {
+    switch (kernel) {
+#ifdef COLUMN_SCAN_X86
+    case SCAN_AVX2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+    case SCAN_SSE2:
+        return true;
+#endif
+    case SCAN_SCALAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char *ColumnSnapshot::kernelName(ScanKernel kernel) {
+    switch (kernel) {
+    case SCAN_AVX2:
+        return "avx2";
+    case SCAN_SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
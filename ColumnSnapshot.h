@@ -0,0 +1,56 @@
+#ifndef COLUMNSNAPSHOT_H
+#define COLUMNSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "RBTree.h"
+
+enum ScanKernel { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+
+// Read-only copy of the columns a filter looks at (ID, GPA, department
+// code), one row per student in ID order, for queries like "everyone in
+// CS with 3.0 <= GPA <= 3.5". A scan compares whole blocks of rows with
+// SIMD instructions instead of walking the tree and calling getters.
+//
+// The kernel is picked at run time: AVX2 when the CPU has it, otherwise
+// SSE2 (always there on x86-64), otherwise plain C++. The snapshot does
+// not follow later changes to the tree; take a new one after updates.
+class ColumnSnapshot {
+public:
+    // Matches rows with minGpa <= GPA <= maxGpa (NaN never matches) and,
+    // unless anyDepartment is set, department code deptCode. Codes come
+    // from the tree's DepartmentIndex.
+    struct Filter {
+        bool anyDepartment;
+        uint16_t deptCode;
+        double minGpa;
+        double maxGpa;
+    };
+
+private:
+    std::vector<int> ids;
+    std::vector<double> gpas;
+    std::vector<uint16_t> deptCodes;
+
+public:
+    ColumnSnapshot();
+    explicit ColumnSnapshot(const RBTree& tree);
+
+    void rebuild(const RBTree& tree);
+    std::size_t size() const;
+    int getId(std::size_t row) const;
+
+    // Bit (row % 64) of word (row / 64) is set for each matching row.
+    std::vector<uint64_t> matchBitmap(const Filter& filter) const;
+    std::vector<uint64_t> matchBitmap(const Filter& filter, ScanKernel kernel) const;
+    // Matching IDs in ascending order.
+    std::vector<int> matchIds(const Filter& filter) const;
+    std::size_t countMatches(const Filter& filter) const;
+
+    static ScanKernel bestKernel();
+    static bool kernelSupported(ScanKernel kernel);
+    static const char *kernelName(ScanKernel kernel);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "ConcurrentRBTree.h"
+
+using namespace std;
+
+ConcurrentRBTree::ConcurrentRBTree(size_t lockShards) : treeLock(lockShards), writes(0) {}
+
+bool ConcurrentRBTree::insert(const RBTree::Student& student) {
+    return insert(student.getId(), student.getName(), student.getDept(), student.getGpa());
+}
+
+bool ConcurrentRBTree::insert(int id, string_view name, string_view dept, double gpa) {
+    unique_lock<ShardedSharedMutex> lock(treeLock);
+    writes++;
+    return tree.insert(id, name, dept, gpa);
+}
+
+bool ConcurrentRBTree::deleteNode(int id) {
+    unique_lock<ShardedSharedMutex> lock(treeLock);
+    writes++;
+    return tree.deleteNode(id);
+}
+
+size_t ConcurrentRBTree::bulkLoad(vector<RBTree::Student> students, vector<int> *duplicates,
+                                  vector<int> *invalid) {
+    unique_lock<ShardedSharedMutex> lock(treeLock);
+    writes++;
+    return tree.bulkLoad(std::move(students), duplicates, invalid);
+}
+
+optional<RBTree::Student> ConcurrentRBTree::find(int id) const {
+    shared_lock<ShardedSharedMutex> lock(treeLock);
+    RBTree::const_iterator it = tree.find(id);
+    if (it == tree.end()) {
+        return nullopt;
+    }
+    return it->toStudent();
+}
+
+bool ConcurrentRBTree::contains(int id) const {
+    shared_lock<ShardedSharedMutex> lock(treeLock);
+    return tree.find(id) != tree.end();
+}
+
+vector<RBTree::Student> ConcurrentRBTree::rangeQuery(int minID, int maxID) const {
+    vector<RBTree::Student> result;
+    shared_lock<ShardedSharedMutex> lock(treeLock);
+    for (RBTree::StudentView student : tree.range(minID, maxID)) {
+        result.push_back(student.toStudent());
+    }
+    return result;
+}
+
+size_t ConcurrentRBTree::size() const {
+    shared_lock<ShardedSharedMutex> lock(treeLock);
+    return tree.size();
+}
+
+uint64_t ConcurrentRBTree::version() const {
+    return writes.load();
+}
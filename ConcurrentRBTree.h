@@ -0,0 +1,80 @@
+#ifndef CONCURRENTRBTREE_H
+#define CONCURRENTRBTREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "RBTree.h"
+#include "ShardedSharedMutex.h"
+
+// Thread-safe RBTree. Any number of threads may search, scan ranges and
+// traverse at the same time; insert/delete (and their fixInsert/fixDelete
+// rotations) run alone. Results are copied out because references into
+// the tree would outlive the read lock.
+class ConcurrentRBTree {
+private:
+    RBTree tree;
+    mutable ShardedSharedMutex treeLock;
+    std::atomic<uint64_t> writes;
+
+public:
+    // lockShards: reader shards of the lock, 0 = one per hardware thread.
+    explicit ConcurrentRBTree(std::size_t lockShards = 0);
+
+    bool insert(const RBTree::Student& student);
+    bool insert(int id, std::string_view name, std::string_view dept, double gpa);
+    bool deleteNode(int id);
+    std::size_t bulkLoad(std::vector<RBTree::Student> students, std::vector<int> *duplicates = nullptr,
+                         std::vector<int> *invalid = nullptr);
+
+    std::optional<RBTree::Student> find(int id) const;
+    bool contains(int id) const;
+    std::vector<RBTree::Student> rangeQuery(int minID, int maxID) const;
+    std::size_t size() const;
+    // Number of write-locked operations started so far. Stable while a read
+    // lock is held (e.g. inside read()); inside write() it identifies that
+    // write. Lets a reader tell whether iterators it kept are still valid.
+    uint64_t version() const;
+
+    // Calls visit(const StudentView&) for each student in [minID, maxID]
+    // while holding the read lock; visit must not call back into this tree
+    // or keep the view past the call.
+    template <typename Visitor>
+    void forEachInRange(int minID, int maxID, Visitor visit) const {
+        std::shared_lock<ShardedSharedMutex> lock(treeLock);
+        for (RBTree::StudentView student : tree.range(minID, maxID)) {
+            visit(student);
+        }
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        std::shared_lock<ShardedSharedMutex> lock(treeLock);
+        for (RBTree::StudentView student : tree) {
+            visit(student);
+        }
+    }
+
+    // Runs fn(const RBTree&) under the read lock, fn(RBTree&) under the
+    // write lock, for anything the wrappers above do not cover.
+    template <typename Fn>
+    auto read(Fn fn) const {
+        std::shared_lock<ShardedSharedMutex> lock(treeLock);
+        return fn(static_cast<const RBTree&>(tree));
+    }
+
+    template <typename Fn>
+    auto write(Fn fn) {
+        std::unique_lock<ShardedSharedMutex> lock(treeLock);
+        writes++;
+        return fn(tree);
+    }
+};
+
+#endif
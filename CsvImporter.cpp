@@ -0,0 +1,263 @@
+#include "CsvImporter.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+struct ChunkResult {
+    vector<RBTree::Student> students;
+    size_t rowsRead = 0;
+    size_t rejected = 0;
+    vector<string> errors;
+};
+
+string_view trim(string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Splits one line into fields. Quoted fields may contain the delimiter and
+// "" for a literal quote; unquoted fields come back as views into the line.
+size_t splitFields(string_view line, char delimiter, string_view *fields, string *unquoted,
+                   size_t maxFields) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < maxFields) {
+        while (pos < line.size() && line[pos] == ' ') {
+            pos++;
+        }
+        if (pos < line.size() && line[pos] == '"') {
+            string& text = unquoted[count];
+            text.clear();
+            pos++;
+            while (pos < line.size()) {
+                if (line[pos] == '"') {
+                    if (pos + 1 < line.size() && line[pos + 1] == '"') {
+                        text += '"';
+                        pos += 2;
+                        continue;
+                    }
+                    pos++;
+                    break;
+                }
+                text += line[pos++];
+            }
+            fields[count++] = text;
+            while (pos < line.size() && line[pos] != delimiter) {
+                pos++;
+            }
+        } else {
+            size_t end = line.find(delimiter, pos);
+            if (end == string_view::npos) {
+                end = line.size();
+            }
+            fields[count++] = trim(line.substr(pos, end - pos));
+            pos = end;
+        }
+        if (pos >= line.size()) {
+            break;
+        }
+        pos++;
+    }
+    return count;
+}
+
+bool equalsIgnoreCase(string_view text, string_view expected) {
+    return text.size() == expected.size()
+        && equal(text.begin(), text.end(), expected.begin(), [](char a, char b) {
+               return tolower(static_cast<unsigned char>(a)) == b;
+           });
+}
+
+// A header names the four columns: id, name, department (or dept), gpa,
+// in any letter case.
+bool isHeader(const string_view *fields, size_t count) {
+    return count == 4 && equalsIgnoreCase(fields[0], "id") && equalsIgnoreCase(fields[1], "name")
+        && (equalsIgnoreCase(fields[2], "department") || equalsIgnoreCase(fields[2], "dept"))
+        && equalsIgnoreCase(fields[3], "gpa");
+}
+
+template <typename T>
+bool parseNumber(string_view text, T& value) {
+    text = trim(text);
+    if (text.empty()) {
+        return false;
+    }
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == errc() && result.ptr == text.data() + text.size();
+}
+
+void parseChunk(const char *begin, const char *end, char delimiter, const char *fileStart,
+                ChunkResult& out) {
+    string_view fields[4];
+    string unquoted[4];
+    const char *lineStart = begin;
+
+    auto reject = [&](const char *line, const string& reason) {
+        out.rejected++;
+        if (out.errors.size() < CsvImporter::MAX_REPORTED_ERRORS) {
+            out.errors.push_back("byte " + to_string(size_t(line - fileStart)) + ": " + reason);
+        }
+    };
+
+    while (lineStart < end) {
+        const char *lineEnd = static_cast<const char*>(memchr(lineStart, '\n', size_t(end - lineStart)));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        string_view line(lineStart, size_t(lineEnd - lineStart));
+        const char *current = lineStart;
+        lineStart = lineEnd + 1;
+
+        if (trim(line).empty()) {
+            continue;
+        }
+        out.rowsRead++;
+
+        if (splitFields(line, delimiter, fields, unquoted, 4) != 4) {
+            reject(current, "expected 4 fields (id, name, department, gpa)");
+            continue;
+        }
+
+        int id;
+        double gpa;
+        if (!parseNumber(fields[0], id)) {
+            reject(current, "invalid ID");
+            continue;
+        }
+        if (fields[1].empty() || fields[2].empty()) {
+            reject(current, "name and department cannot be empty");
+            continue;
+        }
+        // Same bounds the GUI's Add Student form enforces; from_chars accepts
+        // "nan" and "inf", which the comparisons alone would let through.
+        if (!parseNumber(fields[3], gpa) || !isfinite(gpa) || gpa < 0.0 || gpa > 4.0) {
+            reject(current, "GPA must be a number between 0.00 and 4.00");
+            continue;
+        }
+        out.students.emplace_back(id, string(fields[1]), string(fields[2]), gpa);
+    }
+}
+
+}
+
+ImportReport::ImportReport() : rowsRead(0), imported(0), rejected(0), duplicates(0), seconds(0.0) {}
+
+double ImportReport::rowsPerSecond() const {
+    return seconds > 0.0 ? double(rowsRead) / seconds : 0.0;
+}
+
+CsvImporter::CsvImporter(unsigned threads) : threadCount(threads) {
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+}
+
+bool CsvImporter::importFile(const string& path, RBTree& tree, ImportReport& report, string *error) {
+    auto start = chrono::steady_clock::now();
+    report = ImportReport();
+
+    MappedFile file;
+    if (!file.open(path)) {
+        if (error != nullptr) {
+            *error = "Cannot open " + path + ".";
+        }
+        return false;
+    }
+    file.adviseSequential();
+    const char *data = reinterpret_cast<const char*>(file.data());
+    size_t size = file.size();
+
+    // Sniff the delimiter and a header line from the first row. Anything
+    // else in the first row, however malformed, is parsed (and rejected)
+    // like a data row.
+    const char *firstEnd = static_cast<const char*>(memchr(data, '\n', size));
+    string_view firstLine(data, firstEnd != nullptr ? size_t(firstEnd - data) : size);
+    char delimiter = firstLine.find('\t') != string_view::npos ? '\t' : ',';
+    size_t bodyStart = 0;
+    {
+        string_view fields[4];
+        string unquoted[4];
+        if (isHeader(fields, splitFields(firstLine, delimiter, fields, unquoted, 4))) {
+            bodyStart = firstEnd != nullptr ? size_t(firstEnd - data) + 1 : size;
+        }
+    }
+
+    // Cut the body into chunks that start right after a newline. Small
+    // files get a single chunk; threads are not worth it below ~1 MiB.
+    size_t bodySize = size - bodyStart;
+    size_t chunkCount = min<size_t>(threadCount, max<size_t>(1, bodySize / (1 << 20)));
+    vector<size_t> bounds{bodyStart};
+    for (size_t i = 1; i < chunkCount; i++) {
+        size_t pos = max(bounds.back(), bodyStart + bodySize * i / chunkCount);
+        const char *newline = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+        if (newline == nullptr) {
+            break;
+        }
+        bounds.push_back(size_t(newline - data) + 1);
+    }
+    bounds.push_back(size);
+
+    vector<ChunkResult> results(bounds.size() - 1);
+    vector<thread> workers;
+    for (size_t i = 0; i + 1 < bounds.size(); i++) {
+        workers.emplace_back(parseChunk, data + bounds[i], data + bounds[i + 1], delimiter,
+                             data, ref(results[i]));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    vector<RBTree::Student> students;
+    size_t total = 0;
+    for (ChunkResult& result : results) {
+        total += result.students.size();
+    }
+    students.reserve(total);
+    for (ChunkResult& result : results) {
+        report.rowsRead += result.rowsRead;
+        report.rejected += result.rejected;
+        for (string& message : result.errors) {
+            if (report.errors.size() < MAX_REPORTED_ERRORS) {
+                report.errors.push_back(std::move(message));
+            }
+        }
+        move(result.students.begin(), result.students.end(), back_inserter(students));
+        result.students.clear();
+    }
+
+    if (tree.size() == 0) {
+        vector<int> duplicateIds;
+        report.imported = tree.bulkLoad(std::move(students), &duplicateIds);
+        report.duplicates = duplicateIds.size();
+    } else {
+        // Sorted order keeps consecutive inserts on neighbouring paths.
+        stable_sort(students.begin(), students.end(), [](const RBTree::Student& a, const RBTree::Student& b) {
+            return a.getId() < b.getId();
+        });
+        for (const RBTree::Student& student : students) {
+            if (tree.insert(student)) {
+                report.imported++;
+            } else {
+                report.duplicates++;
+            }
+        }
+    }
+
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
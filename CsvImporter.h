@@ -0,0 +1,42 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "RBTree.h"
+
+struct ImportReport {
+    std::size_t rowsRead;
+    std::size_t imported;
+    std::size_t rejected;       // malformed rows and GPAs outside 0.00 - 4.00
+    std::size_t duplicates;     // IDs already in the tree or repeated in the file
+    double seconds;
+    std::vector<std::string> errors;    // the first few rejection reasons
+
+    ImportReport();
+    double rowsPerSecond() const;
+};
+
+// Loads "id,name,department,gpa" rows (comma- or tab-separated, optional
+// header line naming those columns, double-quoted fields allowed) into an
+// RBTree.
+//
+// The file is mapped, cut into chunks on line boundaries and parsed by
+// several threads at once; the rows are then sorted by ID and handed to
+// the tree in one batch (bulkLoad() when the tree is empty). Quoted fields
+// must not contain line breaks.
+class CsvImporter {
+private:
+    unsigned threadCount;
+
+public:
+    static const std::size_t MAX_REPORTED_ERRORS = 10;
+
+    explicit CsvImporter(unsigned threads = 0);
+
+    bool importFile(const std::string& path, RBTree& tree, ImportReport& report,
+                    std::string *error = nullptr);
+};
+
+#endif
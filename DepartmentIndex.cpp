@@ -0,0 +1,87 @@
+#include "DepartmentIndex.h"
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+const set<int> EMPTY_ROSTER;
+}
+
+uint16_t DepartmentIndex::intern(string_view dept) {
+    auto it = codes.find(dept);
+    if (it != codes.end()) {
+        return it->second;
+    }
+    if (names.size() >= MAX_DEPARTMENTS) {
+        throw length_error("DepartmentIndex: too many distinct departments");
+    }
+    uint16_t code = static_cast<uint16_t>(names.size());
+    names.emplace_back(dept);
+    codes.emplace(names.back(), code);
+    members.emplace_back();
+    return code;
+}
+
+uint16_t DepartmentIndex::findCode(string_view dept) const {
+    auto it = codes.find(dept);
+    return it != codes.end() ? it->second : NO_DEPARTMENT;
+}
+
+string_view DepartmentIndex::getName(uint16_t code) const {
+    return code < names.size() ? string_view(names[code]) : string_view();
+}
+
+void DepartmentIndex::add(int id, string_view dept) {
+    add(id, intern(dept));
+}
+
+void DepartmentIndex::add(int id, uint16_t code) {
+    set<int>& roster = members[code];
+    // Bulk loads arrive in ID order, which makes the end() hint O(1).
+    roster.insert(roster.end(), id);
+}
+
+void DepartmentIndex::remove(int id, string_view dept) {
+    remove(id, findCode(dept));
+}
+
+void DepartmentIndex::remove(int id, uint16_t code) {
+    if (code < members.size()) {
+        members[code].erase(id);
+    }
+}
+
+void DepartmentIndex::clear() {
+    codes.clear();
+    names.clear();
+    members.clear();
+}
+
+const set<int>& DepartmentIndex::studentsIn(string_view dept) const {
+    uint16_t code = findCode(dept);
+    return code != NO_DEPARTMENT ? members[code] : EMPTY_ROSTER;
+}
+
+size_t DepartmentIndex::countIn(string_view dept) const {
+    return studentsIn(dept).size();
+}
+
+vector<string_view> DepartmentIndex::departments() const {
+    vector<string_view> result;
+    for (uint16_t code = 0; code < names.size(); code++) {
+        if (!members[code].empty()) {
+            result.push_back(names[code]);
+        }
+    }
+    return result;
+}
+
+size_t DepartmentIndex::approximateBytes() const {
+    // A red-black tree node is three pointers and a color ahead of the value.
+    const size_t setNode = 4 * sizeof(void*) + sizeof(int);
+    size_t bytes = members.capacity() * sizeof(set<int>);
+    for (size_t code = 0; code < names.size(); code++) {
+        bytes += sizeof(string) + names[code].capacity() + members[code].size() * setNode;
+    }
+    return bytes + codes.size() * (sizeof(string_view) + sizeof(uint16_t) + 2 * sizeof(void*));
+}
@@ -0,0 +1,58 @@
+#ifndef DEPARTMENTINDEX_H
+#define DEPARTMENTINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Secondary index from department to the sorted set of student IDs in it.
+// Department names are interned: each distinct name is stored once and
+// gets a 16-bit code, so records store two bytes per department and
+// department filters compare codes, not strings. The code -> name table
+// doubles as the dictionary for RecordTable.
+class DepartmentIndex {
+private:
+    std::deque<std::string> names;      // code -> name; deque keeps addresses stable
+    std::unordered_map<std::string_view, uint16_t> codes;
+    std::vector<std::set<int>> members; // code -> IDs
+
+public:
+    static const uint16_t NO_DEPARTMENT = UINT16_MAX;
+    static const std::size_t MAX_DEPARTMENTS = UINT16_MAX;  // codes 0 .. 65534
+
+    // codes points into names, so a copy would point into the original.
+    // A move takes the deque's blocks along and the views stay valid.
+    DepartmentIndex() = default;
+    DepartmentIndex(const DepartmentIndex&) = delete;
+    DepartmentIndex& operator=(const DepartmentIndex&) = delete;
+    DepartmentIndex(DepartmentIndex&&) = default;
+    DepartmentIndex& operator=(DepartmentIndex&&) = default;
+
+    // Throws std::length_error when a new name would exceed MAX_DEPARTMENTS.
+    uint16_t intern(std::string_view dept);
+    uint16_t findCode(std::string_view dept) const;
+    std::string_view getName(uint16_t code) const;
+
+    void add(int id, std::string_view dept);
+    void add(int id, uint16_t code);
+    void remove(int id, std::string_view dept);
+    void remove(int id, uint16_t code);
+    void clear();
+
+    // Sorted IDs of everyone in dept; empty for an unknown department.
+    const std::set<int>& studentsIn(std::string_view dept) const;
+    std::size_t countIn(std::string_view dept) const;
+
+    // Departments that currently have at least one student, by code.
+    std::vector<std::string_view> departments() const;
+
+    // Rough heap footprint, counting a typical node size for each set entry.
+    std::size_t approximateBytes() const;
+};
+
+#endif
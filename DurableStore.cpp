@@ -0,0 +1,110 @@
+#include "DurableStore.h"
+#include "Snapshot.h"
+#include <filesystem>
+
+using namespace std;
+
+DurableStore::DurableStore() : replayed(0), skipped(0) {}
+
+bool DurableStore::open(const string& directory, const WalOptions& options, string *error) {
+    error_code ec;
+    filesystem::create_directories(directory, ec);
+    if (ec) {
+        if (error != nullptr) {
+            *error = "Cannot create " + directory + ": " + ec.message();
+        }
+        return false;
+    }
+
+    snapshotPath = (filesystem::path(directory) / "students.snap").string();
+    walPath = (filesystem::path(directory) / "students.wal").string();
+
+    tree.clear();
+    skipped = 0;
+    if (filesystem::exists(snapshotPath)) {
+        Snapshot snapshot;
+        if (!snapshot.open(snapshotPath, true, error)) {
+            return false;
+        }
+        vector<int> invalid;
+        snapshot.loadInto(tree, &invalid);
+        skipped = invalid.size();
+    }
+
+    if (!WriteAheadLog::replay(walPath, tree, &replayed, error)) {
+        return false;
+    }
+    return wal.open(walPath, options, error);
+}
+
+bool DurableStore::insert(const RBTree::Student& student) {
+    return insert(student.getId(), student.getName(), student.getDept(), student.getGpa());
+}
+
+bool DurableStore::insert(int id, string_view name, string_view dept, double gpa) {
+    if (!RBTree::isValidGpa(gpa) || tree.find(id) != tree.end()) {
+        return false;
+    }
+    if (!wal.appendInsert(id, name, dept, gpa)) {
+        return false;
+    }
+    return tree.insert(id, name, dept, gpa);
+}
+
+bool DurableStore::deleteNode(int id) {
+    if (tree.find(id) == tree.end()) {
+        return false;
+    }
+    if (!wal.appendDelete(id)) {
+        return false;
+    }
+    return tree.deleteNode(id);
+}
+
+bool DurableStore::updateGpa(int id, double gpa) {
+    if (!RBTree::isValidGpa(gpa) || tree.find(id) == tree.end()) {
+        return false;
+    }
+    if (!wal.appendUpdateGpa(id, gpa)) {
+        return false;
+    }
+    return tree.updateGpa(id, gpa);
+}
+
+bool DurableStore::sync() {
+    return wal.sync();
+}
+
+// Writes the current tree as the new snapshot, then empties the log. A
+// crash between the two steps is safe: replaying the old log over the new
+// snapshot reproduces the same tree.
+bool DurableStore::checkpoint(string *error) {
+    if (!wal.sync()) {
+        if (error != nullptr) {
+            *error = "Cannot sync write-ahead log.";
+        }
+        return false;
+    }
+    if (!Snapshot::save(tree, snapshotPath, error)) {
+        return false;
+    }
+    if (!wal.reset()) {
+        if (error != nullptr) {
+            *error = "Snapshot written but the write-ahead log could not be reset.";
+        }
+        return false;
+    }
+    return true;
+}
+
+RBTree& DurableStore::getTree() {
+    return tree;
+}
+
+size_t DurableStore::getReplayedCount() const {
+    return replayed;
+}
+
+size_t DurableStore::getSkippedCount() const {
+    return skipped;
+}
@@ -0,0 +1,47 @@
+#ifndef DURABLESTORE_H
+#define DURABLESTORE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "RBTree.h"
+#include "WriteAheadLog.h"
+
+// An RBTree whose mutations survive a crash.
+//
+// The directory holds students.snap (the last checkpoint) and students.wal
+// (every successful insert/delete/GPA update since). open() loads the
+// snapshot and replays the log on top; checkpoint() compacts the log into
+// a new snapshot. Reads go straight to getTree().
+class DurableStore {
+private:
+    RBTree tree;
+    WriteAheadLog wal;
+    std::string snapshotPath;
+    std::string walPath;
+    std::size_t replayed;
+    std::size_t skipped;
+
+public:
+    DurableStore();
+
+    bool open(const std::string& directory, const WalOptions& options = WalOptions(),
+              std::string *error = nullptr);
+
+    // Both return false, leaving tree and log untouched, when the operation
+    // would not change the tree or the log append fails.
+    bool insert(const RBTree::Student& student);
+    bool insert(int id, std::string_view name, std::string_view dept, double gpa);
+    bool deleteNode(int id);
+    bool updateGpa(int id, double gpa);
+
+    bool sync();
+    bool checkpoint(std::string *error = nullptr);
+
+    RBTree& getTree();
+    std::size_t getReplayedCount() const;
+    // Snapshot records open() dropped for an invalid GPA.
+    std::size_t getSkippedCount() const;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "GpaIndex.h"
+#include <climits>
+#include <cmath>
+#include <iterator>
+
+using namespace std;
+
+GpaIndex::GpaIndex() : bucketTree(BUCKETS + 1, 0) {}
+
+size_t GpaIndex::bucketFor(double gpa) {
+    double hundredths = round(gpa * 100.0);
+    if (!(hundredths > 0.0)) {
+        return 0;       // also catches NaN
+    }
+    if (hundredths >= double(BUCKETS - 1)) {
+        return BUCKETS - 1;
+    }
+    return size_t(hundredths);
+}
+
+void GpaIndex::adjust(size_t bucket, bool added) {
+    for (size_t i = bucket + 1; i <= BUCKETS; i += i & (~i + 1)) {
+        if (added) {
+            bucketTree[i]++;
+        } else {
+            bucketTree[i]--;
+        }
+    }
+}
+
+void GpaIndex::add(int id, double gpa) {
+    if (entries.emplace(gpa, id).second) {
+        adjust(bucketFor(gpa), true);
+    }
+}
+
+void GpaIndex::remove(int id, double gpa) {
+    if (entries.erase(Entry(gpa, id)) > 0) {
+        adjust(bucketFor(gpa), false);
+    }
+}
+
+void GpaIndex::clear() {
+    entries.clear();
+    bucketTree.assign(BUCKETS + 1, 0);
+}
+
+size_t GpaIndex::size() const {
+    return entries.size();
+}
+
+const set<GpaIndex::Entry>& GpaIndex::getEntries() const {
+    return entries;
+}
+
+set<GpaIndex::Entry>::const_iterator GpaIndex::lowerBound(double gpa) const {
+    return entries.lower_bound(Entry(gpa, INT_MIN));
+}
+
+set<GpaIndex::Entry>::const_iterator GpaIndex::upperBound(double gpa) const {
+    return entries.upper_bound(Entry(gpa, INT_MAX));
+}
+
+// First entry whose bucket is >= bucket. The value search lands next to the
+// boundary; the two loops settle rounding at the edge, relying only on
+// bucketFor() being monotonic.
+set<GpaIndex::Entry>::const_iterator GpaIndex::bucketBegin(size_t bucket) const {
+    if (bucket == 0) {
+        return entries.begin();
+    }
+    if (bucket >= BUCKETS) {
+        return entries.end();
+    }
+    auto it = lowerBound((double(bucket) - 0.5) / 100.0);
+    while (it != entries.begin() && bucketFor(prev(it)->first) >= bucket) {
+        --it;
+    }
+    while (it != entries.end() && bucketFor(it->first) < bucket) {
+        ++it;
+    }
+    return it;
+}
+
+// Descends the Fenwick tree to the bucket holding the k-th entry, then
+// looks inside it. With GPAs kept to hundredths every entry of a bucket has
+// the same value and the answer is the bucket's first entry; otherwise the
+// bucket is walked, which only costs its own size.
+double GpaIndex::kthLowest(size_t k) const {
+    size_t bucket = 0;
+    size_t remaining = k;
+    size_t step = 1;
+    while (step * 2 <= BUCKETS) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        if (bucket + step <= BUCKETS && bucketTree[bucket + step] <= remaining) {
+            bucket += step;
+            remaining -= bucketTree[bucket];
+        }
+    }
+    // bucket is now the 0-based bucket index, remaining the offset inside it.
+
+    auto first = bucketBegin(bucket);
+    auto last = prev(bucketBegin(bucket + 1));
+    if (first->first == last->first) {
+        return first->first;
+    }
+    return next(first, ptrdiff_t(remaining))->first;
+}
+
+size_t GpaIndex::approximateBytes() const {
+    const size_t setNode = 4 * sizeof(void*) + sizeof(Entry);
+    return entries.size() * setNode + bucketTree.capacity() * sizeof(size_t);
+}
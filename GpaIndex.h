@@ -0,0 +1,47 @@
+#ifndef GPAINDEX_H
+#define GPAINDEX_H
+
+#include <cstddef>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Secondary index ordering students by (GPA, ID), for honor lists,
+// probation lists and percentiles. Next to the ordered set, a Fenwick tree
+// counts students per hundredth of a GPA point (0.00 .. 4.00, anything
+// outside is clamped into the end buckets), which lets percentile() find
+// the k-th smallest GPA without walking the set from one end.
+class GpaIndex {
+public:
+    using Entry = std::pair<double, int>;   // (gpa, id)
+    static const std::size_t BUCKETS = 401;
+
+private:
+    std::set<Entry> entries;
+    std::vector<std::size_t> bucketTree;    // Fenwick tree, 1-based
+
+    static std::size_t bucketFor(double gpa);
+    void adjust(std::size_t bucket, bool added);
+    std::set<Entry>::const_iterator bucketBegin(std::size_t bucket) const;
+
+public:
+    GpaIndex();
+
+    void add(int id, double gpa);
+    void remove(int id, double gpa);
+    void clear();
+    std::size_t size() const;
+
+    const std::set<Entry>& getEntries() const;
+    // [lowerBound(lo), upperBound(hi)) spans the entries with lo <= gpa <= hi.
+    std::set<Entry>::const_iterator lowerBound(double gpa) const;
+    std::set<Entry>::const_iterator upperBound(double gpa) const;
+
+    // GPA of the k-th lowest entry (0-based, k < size()).
+    double kthLowest(std::size_t k) const;
+
+    // Rough heap footprint, counting a typical node size for each set entry.
+    std::size_t approximateBytes() const;
+};
+
+#endif
@@ -1,17 +1,38 @@
 #include "MainWindow.h"
+#include "Metrics.h"
+#include <QFileDialog>
 #include <QGridLayout>
 #include <QHeaderView>
-#include <iostream>
-#include <sstream>
+#include <QSet>
+#include <QSignalBlocker>
+#include <QStatusBar>
+#include <QStringList>
+#include <optional>
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
-    studentTree = new RBTree();
+// How long changes from the worker are collected before the table and the
+// tree display catch up.
+static const int CHANGE_FLUSH_MS = 100;
+
+// Levels opened by "Visualize Tree Structure" (the root is level 0).
+static const int TREE_EXPAND_DEPTH = 3;
+
+static QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent) {
+    studentTree = new ConcurrentRBTree();
     setupUI();
+    setupWorker();
     setWindowTitle("Student Information System - Red-Black Tree");
     resize(1000, 700);
 }
 
 MainWindow::~MainWindow() {
+    // Lets the worker finish the request it is on; queued ones are dropped
+    workerThread.quit();
+    workerThread.wait();
     delete studentTree;
 }
 
@@ -97,6 +118,22 @@ void MainWindow::setupUI() {
     treeViewBtn = new QPushButton("Visualize Tree Structure");
     treeViewBtn->setStyleSheet("background-color: #9C27B0; color: white; font-weight: bold; padding: 10px;");
     displayBtnLayout->addWidget(treeViewBtn);
+
+    metricsBtn = new QPushButton("Show Metrics");
+    metricsBtn->setStyleSheet("background-color: #3F51B5; color: white; padding: 10px;");
+    displayBtnLayout->addWidget(metricsBtn);
+    
+    openSnapshotBtn = new QPushButton("Open Snapshot...");
+    openSnapshotBtn->setStyleSheet("background-color: #795548; color: white; padding: 10px;");
+    displayBtnLayout->addWidget(openSnapshotBtn);
+    
+    saveSnapshotBtn = new QPushButton("Save Snapshot...");
+    saveSnapshotBtn->setStyleSheet("background-color: #795548; color: white; padding: 10px;");
+    displayBtnLayout->addWidget(saveSnapshotBtn);
+    
+    importCsvBtn = new QPushButton("Import CSV...");
+    importCsvBtn->setStyleSheet("background-color: #795548; color: white; padding: 10px;");
+    displayBtnLayout->addWidget(importCsvBtn);
     
     mainLayout->addLayout(displayBtnLayout);
     
@@ -104,10 +141,28 @@ void MainWindow::setupUI() {
     QGroupBox* tableGroup = new QGroupBox("Student Records");
     QVBoxLayout* tableLayout = new QVBoxLayout();
     
-    studentTable = new QTableWidget();
-    studentTable->setColumnCount(4);
-    studentTable->setHorizontalHeaderLabels({"ID", "Name", "Department", "GPA"});
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(new QLabel("Department:"));
+    deptFilter = new QComboBox();
+    deptFilter->addItem("(All departments)");
+    deptFilter->setMinimumWidth(200);
+    filterLayout->addWidget(deptFilter);
+    filterLayout->addWidget(new QLabel("Name:"));
+    nameFilter = new QLineEdit();
+    nameFilter->setPlaceholderText("Type part of a name...");
+    nameFilter->setClearButtonEnabled(true);
+    nameFilter->setMinimumWidth(250);
+    filterLayout->addWidget(nameFilter);
+    filterLayout->addStretch();
+    tableLayout->addLayout(filterLayout);
+    
+    // The model reads rows from the tree on demand; fixed row heights keep
+    // the view from measuring rows it never paints
+    studentModel = new StudentTableModel(studentTree, this);
+    studentTable = new QTableView();
+    studentTable->setModel(studentModel);
     studentTable->horizontalHeader()->setStretchLastSection(true);
+    studentTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     studentTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     studentTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     studentTable->setAlternatingRowColors(true);
@@ -120,15 +175,28 @@ void MainWindow::setupUI() {
     QGroupBox* treeGroup = new QGroupBox("Tree Structure Visualization");
     QVBoxLayout* treeLayout = new QVBoxLayout();
     
-    treeDisplay = new QTextEdit();
-    treeDisplay->setReadOnly(true);
-    treeDisplay->setFont(QFont("Courier New", 10));
-    treeDisplay->setMaximumHeight(200);
-    
-    treeLayout->addWidget(treeDisplay);
+    // Nodes are read from the tree when their parent is expanded, so the
+    // view costs the same for ten students or ten million. An expansion
+    // after the tree changed makes the model stale; take a fresh copy.
+    treeModel = new TreeStructureModel(studentTree, this);
+    connect(treeModel, &TreeStructureModel::stale, this, &MainWindow::refreshTreeView,
+            Qt::QueuedConnection);
+    treeView = new QTreeView();
+    treeView->setModel(treeModel);
+    treeView->setUniformRowHeights(true);
+    treeView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    treeView->setMaximumHeight(250);
+    
+    treeLayout->addWidget(treeView);
     treeGroup->setLayout(treeLayout);
     mainLayout->addWidget(treeGroup);
     
+    // ========== PROGRESS OF LONG OPERATIONS ==========
+    progressBar = new QProgressBar();
+    progressBar->setMaximumWidth(250);
+    progressBar->hide();
+    statusBar()->addPermanentWidget(progressBar);
+    
     // ========== CONNECT SIGNALS AND SLOTS ==========
     connect(addBtn, &QPushButton::clicked, this, &MainWindow::addStudent);
     connect(searchBtn, &QPushButton::clicked, this, &MainWindow::searchStudent);
@@ -136,7 +204,44 @@ void MainWindow::setupUI() {
     connect(showAllBtn, &QPushButton::clicked, this, &MainWindow::showAllStudents);
     connect(rangeBtn, &QPushButton::clicked, this, &MainWindow::showRange);
     connect(treeViewBtn, &QPushButton::clicked, this, &MainWindow::showTreeStructure);
+    connect(metricsBtn, &QPushButton::clicked, this, &MainWindow::showMetrics);
     connect(clearBtn, &QPushButton::clicked, this, &MainWindow::clearForm);
+    connect(deptFilter, &QComboBox::currentIndexChanged, this, &MainWindow::applyDepartmentFilter);
+    connect(nameFilter, &QLineEdit::textChanged, this, &MainWindow::applyNameFilter);
+    connect(openSnapshotBtn, &QPushButton::clicked, this, &MainWindow::openSnapshot);
+    connect(saveSnapshotBtn, &QPushButton::clicked, this, &MainWindow::saveSnapshot);
+    connect(importCsvBtn, &QPushButton::clicked, this, &MainWindow::importCsv);
+}
+
+// All tree work runs on workerThread, so imports and big queries never
+// block the window. Requests go out as signals and are handled one at a
+// time in order; results come back as signals on this thread.
+void MainWindow::setupWorker() {
+    worker = new TreeWorker(studentTree);
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    
+    connect(this, &MainWindow::addRequested, worker, &TreeWorker::addStudent);
+    connect(this, &MainWindow::deleteRequested, worker, &TreeWorker::deleteStudent);
+    connect(this, &MainWindow::rangeRequested, worker, &TreeWorker::queryRange);
+    connect(this, &MainWindow::loadSnapshotRequested, worker, &TreeWorker::loadSnapshot);
+    connect(this, &MainWindow::saveSnapshotRequested, worker, &TreeWorker::saveSnapshot);
+    connect(this, &MainWindow::importCsvRequested, worker, &TreeWorker::importCsv);
+    
+    connect(worker, &TreeWorker::studentAdded, this, &MainWindow::handleStudentAdded);
+    connect(worker, &TreeWorker::studentDeleted, this, &MainWindow::handleStudentDeleted);
+    connect(worker, &TreeWorker::treeChanged, this, &MainWindow::queueTreeChanges);
+    connect(worker, &TreeWorker::departmentsChanged, this, &MainWindow::updateDepartmentFilter);
+    connect(worker, &TreeWorker::rangeReady, this, &MainWindow::showRangeResult);
+    connect(worker, &TreeWorker::progress, this, &MainWindow::showProgress);
+    connect(worker, &TreeWorker::operationFinished, this, &MainWindow::finishOperation);
+    
+    changeTimer = new QTimer(this);
+    changeTimer->setSingleShot(true);
+    changeTimer->setInterval(CHANGE_FLUSH_MS);
+    connect(changeTimer, &QTimer::timeout, this, &MainWindow::flushTreeChanges);
+    
+    workerThread.start();
 }
 
 void MainWindow::addStudent() {
@@ -157,18 +262,25 @@ void MainWindow::addStudent() {
         return;
     }
     
-    if (!ok || gpa < 0.0 || gpa > 4.0) {
+    // toDouble() accepts "nan" and "inf", which the tree would refuse
+    if (!ok || !RBTree::isValidGpa(gpa)) {
         QMessageBox::warning(this, "Invalid Input", "Please enter a valid GPA (0.00 - 4.00).");
         return;
     }
     
-    studentTree->insert(id, name.toStdString(), dept.toStdString(), gpa);
+    emit addRequested(id, name, dept, gpa);
+}
+
+void MainWindow::handleStudentAdded(int id, const QString& name, const QString& error) {
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, QString("Cannot Add Student %1").arg(id), error);
+        return;
+    }
     
     QMessageBox::information(this, "Success", 
         QString("Student %1 added successfully!").arg(name));
     
     clearForm();
-    refreshStudentTable();
 }
 
 void MainWindow::searchStudent() {
@@ -180,18 +292,19 @@ void MainWindow::searchStudent() {
         return;
     }
     
-    RBTree::Node* result = studentTree->searchTree(id);
+    // A point lookup only waits for the worker's short write locks
+    std::optional<RBTree::Student> result = studentTree->find(id);
     
-    if (result != nullptr && result->getData().getId() != 0) {
-        RBTree::Student student = result->getData();
+    if (result) {
+        const RBTree::Student& student = *result;
         QString msg = QString("Student Found!\n\n"
                              "ID: %1\n"
                              "Name: %2\n"
                              "Department: %3\n"
                              "GPA: %4")
                              .arg(student.getId())
-                             .arg(QString::fromStdString(student.getName()))
-                             .arg(QString::fromStdString(student.getDept()))
+                             .arg(toQString(student.getName()))
+                             .arg(toQString(student.getDept()))
                              .arg(student.getGpa(), 0, 'f', 2);
         
         QMessageBox::information(this, "Search Result", msg);
@@ -217,13 +330,20 @@ void MainWindow::deleteStudent() {
         QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        studentTree->deleteNode(id);
-        QMessageBox::information(this, "Success", "Student deleted (if found).");
-        deleteIdInput->clear();
-        refreshStudentTable();
+        emit deleteRequested(id);
     }
 }
 
+void MainWindow::handleStudentDeleted(int id, bool deleted) {
+    if (!deleted) {
+        QMessageBox::information(this, "Not Found", 
+            QString("No student found with ID: %1").arg(id));
+        return;
+    }
+    QMessageBox::information(this, "Success", "Student deleted.");
+    deleteIdInput->clear();
+}
+
 void MainWindow::showAllStudents() {
     refreshStudentTable();
     QMessageBox::information(this, "Display Updated", 
@@ -245,75 +365,41 @@ void MainWindow::showRange() {
         return;
     }
     
-    // Clear table and show only range
-    studentTable->setRowCount(0);
-    
-    // Capture output using a helper method
-    std::stringstream ss;
-    std::streambuf* oldCout = std::cout.rdbuf(ss.rdbuf());
-    studentTree->printRange(minId, maxId);
-    std::cout.rdbuf(oldCout);
-    
-    QString output = QString::fromStdString(ss.str());
+    emit rangeRequested(minId, maxId);
+}
+
+void MainWindow::showRangeResult(int minId, int maxId, const QStringList& lines) {
+    progressBar->hide();
+    statusBar()->clearMessage();
     
-    if (output.isEmpty() || output.contains("No students found")) {
+    if (lines.isEmpty()) {
         QMessageBox::information(this, "Range Query", 
             QString("No students found in range %1 to %2").arg(minId).arg(maxId));
     } else {
         QMessageBox::information(this, "Range Query", 
-            QString("Students in range %1 to %2:\n\n%3").arg(minId).arg(maxId).arg(output));
+            QString("Students in range %1 to %2:\n\n%3").arg(minId).arg(maxId).arg(lines.join("\n")));
     }
-    
-    refreshStudentTable();
 }
 
 void MainWindow::showTreeStructure() {
-    RBTree::Node* root = studentTree->getRoot();
-    
-    if (root == nullptr || root->getData().getId() == 0) {
-        treeDisplay->setText("Tree is empty.");
-        return;
-    }
-    
-    QString structure = "Red-Black Tree Structure:\n";
-    structure += "(R = Red node, B = Black node)\n\n";
-    structure += getTreeStructure(root, "", true);
-    
-    treeDisplay->setText(structure);
+    treeView->collapseAll();
+    treeView->expandToDepth(TREE_EXPAND_DEPTH - 1);
 }
 
-QString MainWindow::getTreeStructure(RBTree::Node* node, const QString& indent, bool last) {
-    QString result;
-    
-    if (node == nullptr || node->getData().getId() == 0) {
-        return result;
-    }
-    
-    result += indent;
-    if (last) {
-        result += "└─";
-    } else {
-        result += "├─";
-    }
-    
-    QString color = (node->getColor() == RED) ? "R" : "B";
-    result += QString("[%1] ID:%2 (%3)\n")
-                 .arg(color)
-                 .arg(node->getData().getId())
-                 .arg(QString::fromStdString(node->getData().getName()));
-    
-    QString newIndent = indent + (last ? "  " : "│ ");
-    
-    if (node->getLeft() && node->getLeft()->getData().getId() != 0) {
-        bool isLast = (node->getRight() == nullptr || node->getRight()->getData().getId() == 0);
-        result += getTreeStructure(node->getLeft(), newIndent, isLast);
-    }
-    
-    if (node->getRight() && node->getRight()->getData().getId() != 0) {
-        result += getTreeStructure(node->getRight(), newIndent, true);
-    }
-    
-    return result;
+// The counters are process-wide, so the report covers the worker's writes
+// and the window's reads alike; the JSON form is under "Show Details".
+void MainWindow::showMetrics() {
+    QString text;
+    QString json;
+    studentTree->read([&](const RBTree& t) {
+        text = QString::fromStdString(Metrics::formatText(t));
+        json = QString::fromStdString(Metrics::formatJson(t));
+    });
+    QMessageBox box(this);
+    box.setWindowTitle("Tree Metrics");
+    box.setText("<pre>" + text.toHtmlEscaped() + "</pre>");
+    box.setDetailedText(json);
+    box.exec();
 }
 
 void MainWindow::clearForm() {
@@ -324,42 +410,135 @@ void MainWindow::clearForm() {
     idInput->setFocus();
 }
 
-void MainWindow::collectStudents(RBTree::Node* node, QList<RBTree::Student>& students) {
-    if (node == nullptr || node->getData().getId() == 0) {
+void MainWindow::saveSnapshot() {
+    QString path = QFileDialog::getSaveFileName(this, "Save Snapshot", QString(),
+                                                "Student snapshots (*.snap);;All files (*)");
+    if (path.isEmpty()) {
         return;
     }
-    
-    // Inorder traversal: left -> current -> right (sorted by ID)
-    collectStudents(node->getLeft(), students);
-    students.append(node->getData());
-    collectStudents(node->getRight(), students);
+    emit saveSnapshotRequested(path);
+}
+
+void MainWindow::openSnapshot() {
+    QString path = QFileDialog::getOpenFileName(this, "Open Snapshot", QString(),
+                                                "Student snapshots (*.snap);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    emit loadSnapshotRequested(path);
+}
+
+void MainWindow::importCsv() {
+    QString path = QFileDialog::getOpenFileName(this, "Import CSV", QString(),
+                                                "CSV files (*.csv *.tsv *.txt);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    emit importCsvRequested(path);
+}
+
+void MainWindow::showProgress(const QString& stage, qint64 done, qint64 total) {
+    if (total > 0) {
+        progressBar->setRange(0, 100);
+        progressBar->setValue(static_cast<int>(done * 100 / total));
+    } else {
+        progressBar->setRange(0, 0);    // busy indicator
+    }
+    progressBar->show();
+    statusBar()->showMessage(stage);
+}
+
+void MainWindow::finishOperation(const QString& title, const QString& message, bool ok) {
+    progressBar->hide();
+    statusBar()->clearMessage();
+    if (ok) {
+        QMessageBox::information(this, title, message);
+    } else {
+        QMessageBox::warning(this, title, message);
+    }
+}
+
+void MainWindow::queueTreeChanges(const QList<TreeChange>& changes) {
+    pendingChanges.append(changes);
+    if (!changeTimer->isActive()) {
+        changeTimer->start();
+    }
+}
+
+void MainWindow::flushTreeChanges() {
+    studentModel->applyChanges(pendingChanges);
+    pendingChanges.clear();
+    refreshTreeView();
 }
 
 void MainWindow::refreshStudentTable() {
-    studentTable->setRowCount(0);
-    
-    // Collect all students from tree
-    QList<RBTree::Student> students;
-    collectStudents(studentTree->getRoot(), students);
-    
-    // Populate table
-    studentTable->setRowCount(students.size());
-    
-    for (int i = 0; i < students.size(); ++i) {
-        const RBTree::Student& student = students[i];
-        
-        QTableWidgetItem* idItem = new QTableWidgetItem(QString::number(student.getId()));
-        QTableWidgetItem* nameItem = new QTableWidgetItem(QString::fromStdString(student.getName()));
-        QTableWidgetItem* deptItem = new QTableWidgetItem(QString::fromStdString(student.getDept()));
-        QTableWidgetItem* gpaItem = new QTableWidgetItem(QString::number(student.getGpa(), 'f', 2));
-        
-        studentTable->setItem(i, 0, idItem);
-        studentTable->setItem(i, 1, nameItem);
-        studentTable->setItem(i, 2, deptItem);
-        studentTable->setItem(i, 3, gpaItem);
+    fillStudentTable();
+    refreshTreeView();
+}
+
+// Resets the tree model, then expands again the nodes (by ID) that were
+// open before, fetching their children from the new copy of the tree.
+// Only expanded nodes are visited, so the cost follows what the user
+// opened, not the size of the tree.
+void MainWindow::refreshTreeView() {
+    QSet<int> expanded;
+    QList<QModelIndex> open{QModelIndex()};
+    while (!open.isEmpty()) {
+        QModelIndex parent = open.takeLast();
+        for (int row = 0; row < treeModel->rowCount(parent); ++row) {
+            QModelIndex child = treeModel->index(row, 0, parent);
+            if (treeView->isExpanded(child)) {
+                expanded.insert(treeModel->idOf(child));
+                open.append(child);
+            }
+        }
     }
     
-    // Also update tree structure display
-    showTreeStructure();
+    treeModel->reload();
+    
+    open = {QModelIndex()};
+    while (!open.isEmpty()) {
+        QModelIndex parent = open.takeLast();
+        for (int row = 0; row < treeModel->rowCount(parent); ++row) {
+            QModelIndex child = treeModel->index(row, 0, parent);
+            if (expanded.contains(treeModel->idOf(child))) {
+                treeModel->fetchMore(child);
+                treeView->expand(child);
+                open.append(child);
+            }
+        }
+    }
+}
+
+void MainWindow::fillStudentTable() {
+    // The model lists everyone, the selected department's roster, or the
+    // first name matches (within the department, if one is selected)
+    std::string name = nameFilter->text().trimmed().toStdString();
+    std::string dept = deptFilter->currentIndex() > 0 ? deptFilter->currentText().toStdString()
+                                                      : std::string();
+    studentModel->setFilter(name, dept);
+}
+
+void MainWindow::updateDepartmentFilter(const QStringList& departments) {
+    QString selected = deptFilter->currentIndex() > 0 ? deptFilter->currentText() : QString();
+    
+    QSignalBlocker blocker(deptFilter);
+    deptFilter->clear();
+    deptFilter->addItem("(All departments)");
+    deptFilter->addItems(departments);
+    
+    int index = selected.isEmpty() ? 0 : deptFilter->findText(selected);
+    deptFilter->setCurrentIndex(index < 0 ? 0 : index);
+    if (index < 0) {
+        fillStudentTable();   // the selected department has no students left
+    }
+}
+
+void MainWindow::applyDepartmentFilter() {
+    fillStudentTable();
+}
+
+void MainWindow::applyNameFilter() {
+    fillStudentTable();
 }
 
@@ -5,14 +5,21 @@
 #include <QWidget>
 #include <QPushButton>
 #include <QLineEdit>
-#include <QTextEdit>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
-#include <QTableWidget>
+#include <QComboBox>
+#include <QTableView>
 #include <QMessageBox>
-#include "RBTree.h"
+#include <QProgressBar>
+#include <QThread>
+#include <QTimer>
+#include <QTreeView>
+#include "ConcurrentRBTree.h"
+#include "StudentTableModel.h"
+#include "TreeStructureModel.h"
+#include "TreeWorker.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -28,16 +35,49 @@ private slots:
     void showAllStudents();
     void showRange();
     void showTreeStructure();
+    void showMetrics();
     void clearForm();
+    void saveSnapshot();
+    void openSnapshot();
+    void importCsv();
+    void applyDepartmentFilter();
+    void applyNameFilter();
+    
+    // Results from the worker thread
+    void handleStudentAdded(int id, const QString& name, const QString& error);
+    void handleStudentDeleted(int id, bool deleted);
+    void queueTreeChanges(const QList<TreeChange>& changes);
+    void flushTreeChanges();
+    void updateDepartmentFilter(const QStringList& departments);
+    void showRangeResult(int minId, int maxId, const QStringList& lines);
+    void showProgress(const QString& stage, qint64 done, qint64 total);
+    void finishOperation(const QString& title, const QString& message, bool ok);
+
+signals:
+    // Requests for the worker thread
+    void addRequested(int id, const QString& name, const QString& dept, double gpa);
+    void deleteRequested(int id);
+    void rangeRequested(int minId, int maxId);
+    void loadSnapshotRequested(const QString& path);
+    void saveSnapshotRequested(const QString& path);
+    void importCsvRequested(const QString& path);
 
 private:
     void setupUI();
+    void setupWorker();
     void refreshStudentTable();
-    void collectStudents(RBTree::Node* node, QList<RBTree::Student>& students);
-    QString getTreeStructure(RBTree::Node* node, const QString& indent, bool last);
+    void fillStudentTable();
+    void refreshTreeView();
+    
+    // Core data structure, written only by the worker thread
+    ConcurrentRBTree* studentTree;
+    QThread workerThread;
+    TreeWorker* worker;
     
-    // Core data structure
-    RBTree* studentTree;
+    // Changes from the worker wait here briefly so a burst of them updates
+    // the table and the tree view once
+    QList<TreeChange> pendingChanges;
+    QTimer* changeTimer;
     
     // UI Components - Input Form
     QLineEdit* idInput;
@@ -52,8 +92,13 @@ private:
     QLineEdit* maxIdInput;
     
     // UI Components - Display
-    QTableWidget* studentTable;
-    QTextEdit* treeDisplay;
+    QTableView* studentTable;
+    StudentTableModel* studentModel;
+    QComboBox* deptFilter;
+    QLineEdit* nameFilter;
+    QTreeView* treeView;
+    TreeStructureModel* treeModel;
+    QProgressBar* progressBar;
     
     // UI Components - Buttons
     QPushButton* addBtn;
@@ -62,7 +107,11 @@ private:
     QPushButton* showAllBtn;
     QPushButton* rangeBtn;
     QPushButton* treeViewBtn;
+    QPushButton* metricsBtn;
     QPushButton* clearBtn;
+    QPushButton* saveSnapshotBtn;
+    QPushButton* openSnapshotBtn;
+    QPushButton* importCsvBtn;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,35 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap on POSIX, a file mapping
+// view on Windows). Pages are faulted in on first touch.
+class MappedFile {
+private:
+    const unsigned char *bytes;
+    std::size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const;
+    const unsigned char* data() const;
+    std::size_t size() const;
+
+    // Hints that the mapping will be read front to back (madvise on POSIX).
+    void adviseSequential() const;
+};
+
+#endif
@@ -0,0 +1,262 @@
+#include "Metrics.h"
+#include "RBTree.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char *const COUNTER_NAMES[Metrics::COUNTER_COUNT] = {
+    "inserts", "duplicate_inserts", "deletes", "missed_deletes", "lookups", "missed_lookups",
+    "range_queries", "bulk_loaded", "left_rotations", "right_rotations",
+    "insert_fixup_steps", "delete_fixup_steps"
+};
+
+const char *const TIMER_NAMES[Metrics::TIMER_COUNT] = {"insert", "delete", "lookup", "range"};
+
+size_t bucketOf(uint64_t ns) {
+    if (ns < 16) {
+        return static_cast<size_t>(ns);
+    }
+    int msb = bit_width(ns) - 1;
+    return static_cast<size_t>(msb - 3) * 16 + static_cast<size_t>((ns >> (msb - 4)) & 15);
+}
+
+uint64_t bucketUpperBound(size_t bucket) {
+    if (bucket < 16) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket / 16) - 1;
+    uint64_t lower = (16 + bucket % 16) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+// Written only by the owning thread, so a relaxed load and store stand in
+// for a locked read-modify-write; other threads only read.
+void bump(atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+struct TimerBlock {
+    atomic<uint64_t> count;
+    atomic<uint64_t> sumNs;
+    atomic<uint64_t> buckets[Metrics::BUCKET_COUNT];
+};
+
+struct ThreadBlock {
+    atomic<uint64_t> counters[Metrics::COUNTER_COUNT];
+    TimerBlock timers[Metrics::TIMER_COUNT];
+};
+
+void addBlock(const ThreadBlock& block, Metrics::Totals& totals) {
+    for (size_t c = 0; c < Metrics::COUNTER_COUNT; c++) {
+        totals.counters[c] += block.counters[c].load(memory_order_relaxed);
+    }
+    for (size_t t = 0; t < Metrics::TIMER_COUNT; t++) {
+        Metrics::Histogram& histogram = totals.timers[t];
+        histogram.count += block.timers[t].count.load(memory_order_relaxed);
+        histogram.sumNs += block.timers[t].sumNs.load(memory_order_relaxed);
+        for (size_t b = 0; b < Metrics::BUCKET_COUNT; b++) {
+            histogram.buckets[b] += block.timers[t].buckets[b].load(memory_order_relaxed);
+        }
+    }
+}
+
+void addTotals(const Metrics::Totals& from, Metrics::Totals& to, bool subtract) {
+    auto apply = [subtract](uint64_t& value, uint64_t amount) {
+        value = subtract ? value - amount : value + amount;
+    };
+    for (size_t c = 0; c < Metrics::COUNTER_COUNT; c++) {
+        apply(to.counters[c], from.counters[c]);
+    }
+    for (size_t t = 0; t < Metrics::TIMER_COUNT; t++) {
+        apply(to.timers[t].count, from.timers[t].count);
+        apply(to.timers[t].sumNs, from.timers[t].sumNs);
+        for (size_t b = 0; b < Metrics::BUCKET_COUNT; b++) {
+            apply(to.timers[t].buckets[b], from.timers[t].buckets[b]);
+        }
+    }
+}
+
+// Blocks of live threads, plus what exited threads recorded. reset() does
+// not touch the blocks (their owners write them without a lock); it keeps
+// the totals at that moment as a baseline to subtract.
+struct Registry {
+    mutex lock;
+    vector<ThreadBlock *> live;
+    Metrics::Totals retired;
+    Metrics::Totals baseline;
+};
+
+// Never destroyed, so threads that outlive main() can still retire.
+Registry& registry() {
+    static Registry *instance = new Registry();
+    return *instance;
+}
+
+struct LocalBlock {
+    ThreadBlock *block;
+
+    LocalBlock() : block(new ThreadBlock()) {
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        r.live.push_back(block);
+    }
+
+    ~LocalBlock() {
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        addBlock(*block, r.retired);
+        r.live.erase(find(r.live.begin(), r.live.end(), block));
+        delete block;
+    }
+};
+
+ThreadBlock& localBlock() {
+    thread_local LocalBlock local;
+    return *local.block;
+}
+
+}
+
+Metrics::Histogram::Histogram() : count(0), sumNs(0) {
+    buckets.fill(0);
+}
+
+double Metrics::Histogram::meanNs() const {
+    return count == 0 ? 0.0 : static_cast<double>(sumNs) / static_cast<double>(count);
+}
+
+uint64_t Metrics::Histogram::percentileNs(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(p / 100.0 * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return bucketUpperBound(b);
+        }
+    }
+    return maxNs();
+}
+
+uint64_t Metrics::Histogram::maxNs() const {
+    for (size_t b = BUCKET_COUNT; b > 0; b--) {
+        if (buckets[b - 1] != 0) {
+            return bucketUpperBound(b - 1);
+        }
+    }
+    return 0;
+}
+
+Metrics::Totals::Totals() {
+    counters.fill(0);
+}
+
+void Metrics::add(Counter counter, uint64_t amount) {
+    bump(localBlock().counters[counter], amount);
+}
+
+void Metrics::record(Timer timer, uint64_t ns) {
+    TimerBlock& block = localBlock().timers[timer];
+    bump(block.count, 1);
+    bump(block.sumNs, ns);
+    bump(block.buckets[bucketOf(ns)], 1);
+}
+
+Metrics::Totals Metrics::totals() {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    Totals totals = r.retired;
+    for (const ThreadBlock *block : r.live) {
+        addBlock(*block, totals);
+    }
+    addTotals(r.baseline, totals, true);
+    return totals;
+}
+
+void Metrics::reset() {
+    Totals current = totals();
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    addTotals(current, r.baseline, false);
+}
+
+const char *Metrics::counterName(Counter counter) {
+    return COUNTER_NAMES[counter];
+}
+
+const char *Metrics::timerName(Timer timer) {
+    return TIMER_NAMES[timer];
+}
+
+string Metrics::formatText(const RBTree& tree) {
+    ostringstream out;
+    size_t students = tree.size();
+    out << "Students:      " << students << "\n";
+    out << "Height:        " << tree.height() << " (red-black bound " << fixed << setprecision(1)
+        << 2.0 * log2(static_cast<double>(students) + 1.0) << ")\n";
+    out << "Black height:  " << tree.blackHeight() << "\n";
+    if (!enabled()) {
+        out << "\nOperation metrics are not compiled in; configure with -DENABLE_METRICS=ON.\n";
+        return out.str();
+    }
+
+    Totals totals = Metrics::totals();
+    out << "\n" << left << setw(22) << "Counter" << right << setw(14) << "Total" << "\n";
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        out << left << setw(22) << COUNTER_NAMES[c] << right << setw(14) << totals.counters[c] << "\n";
+    }
+
+    out << "\n" << left << setw(12) << "Latency (ns)" << right << setw(12) << "Count"
+        << setw(10) << "Mean" << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99"
+        << setw(10) << "p99.9" << setw(10) << "Max" << "\n";
+    for (size_t t = 0; t < TIMER_COUNT; t++) {
+        const Histogram& histogram = totals.timers[t];
+        out << left << setw(12) << TIMER_NAMES[t] << right << setw(12) << histogram.count
+            << setw(10) << setprecision(0) << histogram.meanNs()
+            << setw(10) << histogram.percentileNs(50) << setw(10) << histogram.percentileNs(90)
+            << setw(10) << histogram.percentileNs(99) << setw(10) << histogram.percentileNs(99.9)
+            << setw(10) << histogram.maxNs() << "\n";
+    }
+    return out.str();
+}
+
+string Metrics::formatJson(const RBTree& tree) {
+    ostringstream out;
+    out << "{\"enabled\":" << (enabled() ? "true" : "false")
+        << ",\"students\":" << tree.size()
+        << ",\"height\":" << tree.height()
+        << ",\"blackHeight\":" << tree.blackHeight();
+    if (enabled()) {
+        Totals totals = Metrics::totals();
+        out << ",\"counters\":{";
+        for (size_t c = 0; c < COUNTER_COUNT; c++) {
+            out << (c == 0 ? "" : ",") << "\"" << COUNTER_NAMES[c] << "\":" << totals.counters[c];
+        }
+        out << "},\"latencyNs\":{";
+        for (size_t t = 0; t < TIMER_COUNT; t++) {
+            const Histogram& histogram = totals.timers[t];
+            out << (t == 0 ? "" : ",") << "\"" << TIMER_NAMES[t] << "\":{"
+                << "\"count\":" << histogram.count
+                << ",\"mean\":" << fixed << setprecision(1) << histogram.meanNs()
+                << ",\"p50\":" << histogram.percentileNs(50)
+                << ",\"p90\":" << histogram.percentileNs(90)
+                << ",\"p99\":" << histogram.percentileNs(99)
+                << ",\"p999\":" << histogram.percentileNs(99.9)
+                << ",\"max\":" << histogram.maxNs() << "}";
+        }
+        out << "}";
+    }
+    out << "}";
+    return out.str();
+}
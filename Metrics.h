@@ -0,0 +1,116 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class RBTree;
+
+// Operation counters and latency histograms for the tree. Recording is
+// compiled in only when the build defines STUDENT_RECORDS_METRICS
+// (cmake -DENABLE_METRICS=ON); otherwise the METRIC_* macros expand to
+// nothing and the tree carries no trace of them.
+//
+// Each thread records into its own block with plain relaxed stores, so
+// readers on different threads never contend; totals() adds the blocks up.
+// Height and black height are measured from the tree when a report is
+// formatted, not tracked per operation.
+class Metrics {
+public:
+    // Calls, and the ones that found a duplicate ID or no such ID.
+    enum Counter {
+        INSERTS,
+        DUPLICATE_INSERTS,
+        DELETES,
+        MISSED_DELETES,
+        LOOKUPS,
+        MISSED_LOOKUPS,
+        RANGE_QUERIES,
+        BULK_LOADED,            // students placed by bulkLoad()
+        LEFT_ROTATIONS,
+        RIGHT_ROTATIONS,
+        INSERT_FIXUP_STEPS,     // fixInsert() loop iterations
+        DELETE_FIXUP_STEPS,     // fixDelete() loop iterations
+        COUNTER_COUNT
+    };
+
+    enum Timer { INSERT_TIMER, DELETE_TIMER, LOOKUP_TIMER, RANGE_TIMER, TIMER_COUNT };
+
+    // Log-linear buckets in the manner of HDR histograms: exact below 16 ns,
+    // then 16 buckets per power of two, so a reported latency is within
+    // 1/16 of the true one.
+    static const std::size_t BUCKET_COUNT = 976;
+
+    struct Histogram {
+        uint64_t count;
+        uint64_t sumNs;
+        std::array<uint64_t, BUCKET_COUNT> buckets;
+
+        Histogram();
+        double meanNs() const;
+        // Upper bound of the bucket holding the p-th percentile, 0 <= p <= 100.
+        uint64_t percentileNs(double p) const;
+        uint64_t maxNs() const;
+    };
+
+    struct Totals {
+        std::array<uint64_t, COUNTER_COUNT> counters;
+        std::array<Histogram, TIMER_COUNT> timers;
+
+        Totals();
+    };
+
+    // Times the enclosing scope.
+    class ScopedTimer {
+        Timer timer;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit ScopedTimer(Timer t) : timer(t), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            record(timer, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+
+    static constexpr bool enabled() {
+#ifdef STUDENT_RECORDS_METRICS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void add(Counter counter, uint64_t amount);
+    static void record(Timer timer, uint64_t ns);
+
+    // Everything recorded, by every thread, since the last reset().
+    static Totals totals();
+    static void reset();
+
+    static const char *counterName(Counter counter);
+    static const char *timerName(Timer timer);
+
+    // Reports of totals() plus the tree's size, height and black height,
+    // as aligned text or as one line of JSON. The caller keeps the tree
+    // still (e.g. holds a read lock) while they run; both walk every node.
+    static std::string formatText(const RBTree& tree);
+    static std::string formatJson(const RBTree& tree);
+};
+
+#ifdef STUDENT_RECORDS_METRICS
+#define METRIC_ADD(counter, amount) Metrics::add(Metrics::counter, (amount))
+#define METRIC_COUNT(counter) Metrics::add(Metrics::counter, 1)
+#define METRIC_TIME(timer) Metrics::ScopedTimer metricTimer(Metrics::timer)
+#else
+#define METRIC_ADD(counter, amount) ((void)0)
+#define METRIC_COUNT(counter) ((void)0)
+#define METRIC_TIME(timer) ((void)0)
+#endif
+
+#endif
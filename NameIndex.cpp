@@ -0,0 +1,206 @@
+#include "NameIndex.h"
+#include <algorithm>
+#include <unordered_set>
+
+using namespace std;
+
+namespace {
+
+bool isWordBreak(char c) {
+    return c == ' ' || c == '\t' || c == '-' || c == '\'' || c == '.' || c == ',';
+}
+
+// Calls visit(word) for each word of an already folded name.
+template <typename Visit>
+void forEachWord(string_view folded, Visit visit) {
+    size_t pos = 0;
+    while (pos < folded.size()) {
+        while (pos < folded.size() && isWordBreak(folded[pos])) {
+            pos++;
+        }
+        size_t start = pos;
+        while (pos < folded.size() && !isWordBreak(folded[pos])) {
+            pos++;
+        }
+        if (pos > start) {
+            visit(folded.substr(start, pos - start));
+        }
+    }
+}
+
+}
+
+// First block whose last ID is >= id, or the last block when id is larger
+// than everything in the list.
+size_t NameIndex::PostingList::blockFor(int id) const {
+    auto it = lower_bound(blocks.begin(), blocks.end(), id, [](const vector<int>& block, int value) {
+        return block.back() < value;
+    });
+    size_t index = size_t(it - blocks.begin());
+    return index < blocks.size() ? index : blocks.size() - 1;
+}
+
+void NameIndex::PostingList::insert(int id) {
+    if (blocks.empty()) {
+        blocks.push_back({id});
+        return;
+    }
+    size_t index = blockFor(id);
+    vector<int>& block = blocks[index];
+    auto it = lower_bound(block.begin(), block.end(), id);
+    if (it != block.end() && *it == id) {
+        return;
+    }
+    if (block.size() < POSTING_BLOCK) {
+        block.insert(it, id);
+        return;
+    }
+    // Appends in ID order (bulk loads) start a fresh block and leave the
+    // full one as it is; anything else splits the block in half.
+    if (it == block.end() && index + 1 == blocks.size()) {
+        blocks.push_back({id});
+        return;
+    }
+    size_t half = block.size() / 2;
+    vector<int> upper(block.begin() + ptrdiff_t(half), block.end());
+    block.resize(half);
+    vector<int>& target = id < upper.front() ? block : upper;
+    target.insert(lower_bound(target.begin(), target.end(), id), id);
+    blocks.insert(blocks.begin() + ptrdiff_t(index) + 1, std::move(upper));
+}
+
+void NameIndex::PostingList::erase(int id) {
+    if (blocks.empty()) {
+        return;
+    }
+    size_t index = blockFor(id);
+    vector<int>& block = blocks[index];
+    auto it = lower_bound(block.begin(), block.end(), id);
+    if (it == block.end() || *it != id) {
+        return;
+    }
+    block.erase(it);
+    if (block.empty()) {
+        blocks.erase(blocks.begin() + ptrdiff_t(index));
+    }
+}
+
+size_t NameIndex::PostingList::size() const {
+    size_t count = 0;
+    for (const vector<int>& block : blocks) {
+        count += block.size();
+    }
+    return count;
+}
+
+bool NameIndex::PostingCursor::seek(int id) {
+    const vector<vector<int>>& blocks = list->blocks;
+    if (block < blocks.size() && blocks[block].back() < id) {
+        auto it = lower_bound(blocks.begin() + ptrdiff_t(block) + 1, blocks.end(), id,
+                              [](const vector<int>& b, int value) { return b.back() < value; });
+        block = size_t(it - blocks.begin());
+        pos = 0;
+    }
+    if (block >= blocks.size()) {
+        return false;
+    }
+    const vector<int>& current = blocks[block];
+    pos = size_t(lower_bound(current.begin() + ptrdiff_t(pos), current.end(), id) - current.begin());
+    return true;
+}
+
+string NameIndex::fold(string_view text) {
+    string folded(text);
+    for (char& c : folded) {
+        if (c >= 'A' && c <= 'Z') {
+            c = char(c - 'A' + 'a');
+        }
+    }
+    return folded;
+}
+
+vector<uint32_t> NameIndex::trigramsOf(string_view folded) {
+    vector<uint32_t> grams;
+    if (folded.size() < 3) {
+        return grams;
+    }
+    grams.reserve(folded.size() - 2);
+    for (size_t i = 0; i + 3 <= folded.size(); i++) {
+        grams.push_back(uint32_t(uint8_t(folded[i])) << 16
+                        | uint32_t(uint8_t(folded[i + 1])) << 8
+                        | uint32_t(uint8_t(folded[i + 2])));
+    }
+    sort(grams.begin(), grams.end());
+    grams.erase(unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void NameIndex::add(int id, string_view name) {
+    string folded = fold(name);
+    forEachWord(folded, [&](string_view word) {
+        words.emplace(string(word), id);
+    });
+    for (uint32_t gram : trigramsOf(folded)) {
+        postings[gram].insert(id);
+    }
+}
+
+void NameIndex::remove(int id, string_view name) {
+    string folded = fold(name);
+    forEachWord(folded, [&](string_view word) {
+        words.erase(Word(string(word), id));
+    });
+    for (uint32_t gram : trigramsOf(folded)) {
+        auto posting = postings.find(gram);
+        if (posting == postings.end()) {
+            continue;
+        }
+        posting->second.erase(id);
+        if (posting->second.blocks.empty()) {
+            postings.erase(posting);
+        }
+    }
+}
+
+void NameIndex::clear() {
+    words.clear();
+    postings.clear();
+}
+
+vector<int> NameIndex::prefixMatches(string_view prefix, size_t limit) const {
+    vector<int> ids;
+    string folded = fold(prefix);
+    unordered_set<int> seen;
+    for (auto it = words.lower_bound(Word(folded, INT32_MIN));
+         it != words.end() && ids.size() < limit; ++it) {
+        if (it->first.compare(0, folded.size(), folded) != 0) {
+            break;
+        }
+        if (seen.insert(it->second).second) {
+            ids.push_back(it->second);
+        }
+    }
+    return ids;
+}
+
+size_t NameIndex::approximateBytes() const {
+    const size_t setNode = 4 * sizeof(void*) + sizeof(Word);
+    size_t bytes = 0;
+    for (const Word& word : words) {
+        bytes += setNode;
+        const char *text = word.first.data();
+        const char *object = reinterpret_cast<const char*>(&word.first);
+        if (text < object || text >= object + sizeof(string)) {
+            bytes += word.first.capacity() + 1;     // not in the small-string buffer
+        }
+    }
+    bytes += postings.bucket_count() * sizeof(void*);
+    for (const auto& posting : postings) {
+        bytes += 2 * sizeof(void*) + sizeof(posting);
+        bytes += posting.second.blocks.capacity() * sizeof(vector<int>);
+        for (const vector<int>& block : posting.second.blocks) {
+            bytes += block.capacity() * sizeof(int);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,117 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Secondary index over student names, case-folded (ASCII letters only;
+// other bytes, including UTF-8 sequences, compare as they are).
+//
+// Prefix search: every word of a name is kept as a (word, id) pair in an
+// ordered set, so all words starting with a prefix are one contiguous run.
+// Substring search: every distinct trigram of a name maps to a sorted
+// posting list of IDs; a query intersects the postings of its trigrams and
+// the caller verifies the few candidates left against the real names.
+class NameIndex {
+public:
+    using Word = std::pair<std::string, int>;   // (folded word, id)
+    static const std::size_t POSTING_BLOCK = 256;
+
+private:
+    // Sorted IDs split into blocks of at most POSTING_BLOCK, so adding or
+    // removing an ID in the middle of a common trigram's list (a third of
+    // all names contain "an") shifts one block instead of the whole list.
+    struct PostingList {
+        std::vector<std::vector<int>> blocks;   // each sorted and non-empty
+
+        std::size_t blockFor(int id) const;
+        void insert(int id);
+        void erase(int id);
+        std::size_t size() const;
+    };
+
+    // Forward-only position in a PostingList.
+    struct PostingCursor {
+        const PostingList *list;
+        std::size_t block;
+        std::size_t pos;
+
+        // Moves to the first ID >= id; false once the list is exhausted.
+        bool seek(int id);
+    };
+
+    std::set<Word> words;
+    std::unordered_map<uint32_t, PostingList> postings;
+
+    static std::vector<uint32_t> trigramsOf(std::string_view folded);
+
+public:
+    static std::string fold(std::string_view text);
+
+    void add(int id, std::string_view name);
+    void remove(int id, std::string_view name);
+    void clear();
+
+    // IDs with a name word starting with prefix, in word order and without
+    // repeats, stopping after limit IDs.
+    std::vector<int> prefixMatches(std::string_view prefix, std::size_t limit) const;
+
+    // Calls visit(id), in ID order, for every ID whose name contains all
+    // trigrams of text, until visit returns false. Returns false without
+    // visiting anything when text is shorter than three bytes and the
+    // index cannot narrow the search down.
+    template <typename Visitor>
+    bool forEachSubstringCandidate(std::string_view text, Visitor visit) const;
+
+    // Rough heap footprint, counting a typical node size for each set entry.
+    std::size_t approximateBytes() const;
+};
+
+// Walks the shortest posting list and checks each ID against the others
+// with cursors that only move forward, so the work is bounded by the
+// rarest trigram of the query and stops as soon as the caller has enough.
+template <typename Visitor>
+bool NameIndex::forEachSubstringCandidate(std::string_view text, Visitor visit) const {
+    std::vector<uint32_t> grams = trigramsOf(fold(text));
+    if (grams.empty()) {
+        return false;
+    }
+
+    std::vector<PostingCursor> cursors;
+    cursors.reserve(grams.size());
+    for (uint32_t gram : grams) {
+        auto posting = postings.find(gram);
+        if (posting == postings.end()) {
+            return true;
+        }
+        cursors.push_back({&posting->second, 0, 0});
+    }
+    std::sort(cursors.begin(), cursors.end(), [](const PostingCursor& a, const PostingCursor& b) {
+        return a.list->size() < b.list->size();
+    });
+
+    for (const std::vector<int>& block : cursors[0].list->blocks) {
+        for (int id : block) {
+            bool inAll = true;
+            for (std::size_t i = 1; i < cursors.size() && inAll; i++) {
+                if (!cursors[i].seek(id)) {
+                    return true;
+                }
+                inAll = cursors[i].list->blocks[cursors[i].block][cursors[i].pos] == id;
+            }
+            if (inAll && !visit(id)) {
+                return true;
+            }
+        }
+    }
+    return true;
+}
+
+#endif
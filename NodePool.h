@@ -0,0 +1,104 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Slab allocator for fixed-size tree nodes.
+// Nodes are carved out of large chunks; destroyed nodes go onto an intrusive
+// free list and are reused by the next create(). releaseAll() hands every
+// chunk back at once without touching individual nodes.
+template <typename T>
+class NodePool {
+private:
+    union Slot {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<Slot*> chunks;
+    Slot *freeList;
+    Slot *cursor;
+    Slot *chunkEnd;
+    std::size_t nodesPerChunk;
+    std::size_t liveNodes;
+
+    void grow() {
+        // Aligned new, so over-aligned (e.g. cache-line) node types work too.
+        Slot *chunk = static_cast<Slot*>(::operator new(sizeof(Slot) * nodesPerChunk,
+                                                        std::align_val_t(alignof(Slot))));
+        chunks.push_back(chunk);
+        cursor = chunk;
+        chunkEnd = chunk + nodesPerChunk;
+    }
+
+public:
+    explicit NodePool(std::size_t perChunk = 4096)
+        : freeList(nullptr), cursor(nullptr), chunkEnd(nullptr),
+          nodesPerChunk(perChunk == 0 ? 1 : perChunk), liveNodes(0) {}
+
+    ~NodePool() {
+        releaseAll();
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // Exchanges the chunks, so nodes keep their addresses.
+    void swap(NodePool& other) {
+        std::swap(chunks, other.chunks);
+        std::swap(freeList, other.freeList);
+        std::swap(cursor, other.cursor);
+        std::swap(chunkEnd, other.chunkEnd);
+        std::swap(nodesPerChunk, other.nodesPerChunk);
+        std::swap(liveNodes, other.liveNodes);
+    }
+
+    template <typename... Args>
+    T *create(Args&&... args) {
+        Slot *slot;
+        if (freeList != nullptr) {
+            slot = freeList;
+            freeList = freeList->next;
+        } else {
+            if (cursor == chunkEnd) {
+                grow();
+            }
+            slot = cursor++;
+        }
+        T *node = ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+        ++liveNodes;
+        return node;
+    }
+
+    // Runs the destructor and puts the slot on the free list.
+    void destroy(T *node) {
+        node->~T();
+        Slot *slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+        --liveNodes;
+    }
+
+    // Frees every chunk in O(chunks). Destructors of nodes still alive are NOT
+    // run; the owner must have destroyed them first if T needs it.
+    void releaseAll() {
+        for (Slot *chunk : chunks) {
+            ::operator delete(chunk, std::align_val_t(alignof(Slot)));
+        }
+        chunks.clear();
+        freeList = nullptr;
+        cursor = nullptr;
+        chunkEnd = nullptr;
+        liveNodes = 0;
+    }
+
+    std::size_t size() const { return liveNodes; }
+    std::size_t chunkCount() const { return chunks.size(); }
+    std::size_t capacity() const { return chunks.size() * nodesPerChunk; }
+    std::size_t bytesReserved() const { return chunks.size() * nodesPerChunk * sizeof(Slot); }
+};
+
+#endif
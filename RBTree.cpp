@@ -1,23 +1,39 @@
 #include "RBTree.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 
 using namespace std;
 
+namespace {
+
+void printStudent(const RBTree::StudentView& student) {
+    cout << "ID: " << student.getId()
+         << " | Name: " << student.getName()
+         << " | Dept: " << student.getDept()
+         << " | GPA: " << fixed << setprecision(2) << student.getGpa() << '\n';
+}
+
+}
+
 RBTree::Student::Student() : id(0), name(""), dept(""), gpa(0.0) {}
 
 RBTree::Student::Student(int i, string n, string d, double g) 
-    : id(i), name(n), dept(d), gpa(g) {}
+    : id(i), name(std::move(n)), dept(std::move(d)), gpa(g) {}
 
 int RBTree::Student::getId() const {
     return id;
 }
 
-string RBTree::Student::getName() const {
+string_view RBTree::Student::getName() const {
     return name;
 }
 
-string RBTree::Student::getDept() const {
+string_view RBTree::Student::getDept() const {
     return dept;
 }
 
@@ -41,11 +57,88 @@ void RBTree::Student::setGpa(double g) {
     gpa = g;
 }
 
-RBTree::Node::Node(Student s) 
-    : data(s), color(RED), left(nullptr), right(nullptr), parent(nullptr) {}
+RBTree::StudentView::StudentView(int i, string_view n, string_view d, double g, uint16_t code)
+    : id(i), name(n), dept(d), gpa(g), deptCode(code) {}
+
+RBTree::StudentView::StudentView(const Student& s)
+    : id(s.getId()), name(s.getName()), dept(s.getDept()), gpa(s.getGpa()),
+      deptCode(DepartmentIndex::NO_DEPARTMENT) {}
+
+int RBTree::StudentView::getId() const {
+    return id;
+}
+
+string_view RBTree::StudentView::getName() const {
+    return name;
+}
+
+string_view RBTree::StudentView::getDept() const {
+    return dept;
+}
+
+uint16_t RBTree::StudentView::getDeptCode() const {
+    return deptCode;
+}
+
+double RBTree::StudentView::getGpa() const {
+    return gpa;
+}
+
+RBTree::Student RBTree::StudentView::toStudent() const {
+    return Student(id, string(name), string(dept), gpa);
+}
+
+size_t RBTree::MemoryReport::total() const {
+    return nodeBytes + recordBytes + nameBytes + indexBytes;
+}
+
+double RBTree::MemoryReport::bytesPerStudent() const {
+    return students == 0 ? 0.0 : double(total()) / double(students);
+}
+
+RBTree::GpaStats::GpaStats()
+    : count(0), sum(0.0), sumSquares(0.0),
+      min(numeric_limits<double>::infinity()), max(-numeric_limits<double>::infinity()) {}
+
+void RBTree::GpaStats::add(double gpa) {
+    count++;
+    sum += gpa;
+    sumSquares += gpa * gpa;
+    min = std::min(min, gpa);
+    max = std::max(max, gpa);
+}
 
-RBTree::Student RBTree::Node::getData() const {
-    return data;
+void RBTree::GpaStats::merge(const GpaStats& other) {
+    count += other.count;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+double RBTree::GpaStats::mean() const {
+    return count == 0 ? 0.0 : sum / double(count);
+}
+
+double RBTree::GpaStats::stddev() const {
+    if (count == 0) {
+        return 0.0;
+    }
+    double m = mean();
+    // Rounding can leave a tiny negative variance when all GPAs are equal.
+    double variance = sumSquares / double(count) - m * m;
+    return variance > 0.0 ? sqrt(variance) : 0.0;
+}
+
+RBTree::Node::Node(int key, uint32_t row) 
+    : id(key), record(row), color(RED), left(nullptr), right(nullptr), parent(nullptr) {}
+
+int RBTree::Node::getId() const {
+    return id;
+}
+
+uint32_t RBTree::Node::getRecord() const {
+    return record;
 }
 
 Color RBTree::Node::getColor() const {
@@ -64,8 +157,12 @@ RBTree::Node* RBTree::Node::getParent() const {
     return parent;
 }
 
-void RBTree::Node::setData(const Student& s) {
-    data = s;
+size_t RBTree::Node::getSize() const {
+    return subtree.count;
+}
+
+const RBTree::GpaStats& RBTree::Node::getSubtreeStats() const {
+    return subtree;
 }
 
 void RBTree::Node::setColor(Color c) {
@@ -85,46 +182,16 @@ void RBTree::Node::setParent(RBTree::Node* node) {
 }
 
 void RBTree::initializeNULLNode(RBTree::Node *node, RBTree::Node *parent) {
-    node->data = Student();
     node->parent = parent;
     node->left = nullptr;
     node->right = nullptr;
     node->color = BLACK;
 }
 
-void RBTree::preOrderHelper(RBTree::Node *node) {
-    if (node != TNULL) {
-        cout << node->data.getId() << " ";
-        preOrderHelper(node->left);
-        preOrderHelper(node->right);
-    }
-}
-
-void RBTree::inOrderHelper(RBTree::Node *node) {
-    if (node != TNULL) {
-        inOrderHelper(node->left);
-        cout << "ID: " << node->data.getId() 
-             << " | Name: " << node->data.getName() 
-             << " | Dept: " << node->data.getDept() 
-             << " | GPA: " << fixed << setprecision(2) << node->data.getGpa() << endl;
-        inOrderHelper(node->right);
-    }
-}
-
-RBTree::Node *RBTree::searchTreeHelper(RBTree::Node *node, int key) {
-    if (node == TNULL || key == node->data.getId()) {
-        return node;
-    }
-
-    if (key < node->data.getId()) {
-        return searchTreeHelper(node->left, key);
-    }
-    return searchTreeHelper(node->right, key);
-}
-
 void RBTree::fixDelete(RBTree::Node *x) {
     Node *s;
     while (x != root && x->color == BLACK) {
+        METRIC_COUNT(DELETE_FIXUP_STEPS);
         if (x == x->parent->left) {
             s = x->parent->right;
             if (s->color == RED) {
@@ -193,15 +260,16 @@ void RBTree::rbTransplant(RBTree::Node *u, RBTree::Node *v) {
     v->parent = u->parent;
 }
 
-void RBTree::deleteNodeHelper(RBTree::Node *node, int key) {
+// Returns false (and leaves the tree untouched) when key is not present.
+bool RBTree::deleteNodeHelper(RBTree::Node *node, int key) {
     Node *z = TNULL;
     Node *x, *y;
     while (node != TNULL) {
-        if (node->data.getId() == key) {
+        if (node->id == key) {
             z = node;
         }
 
-        if (node->data.getId() <= key) {
+        if (node->id <= key) {
             node = node->right;
         } else {
             node = node->left;
@@ -209,8 +277,7 @@ void RBTree::deleteNodeHelper(RBTree::Node *node, int key) {
     }
 
     if (z == TNULL) {
-        cout << "Student with ID " << key << " not found in the tree.\n";
-        return;
+        return false;
     }
 
     y = z;
@@ -238,15 +305,24 @@ void RBTree::deleteNodeHelper(RBTree::Node *node, int key) {
         y->left->parent = y;
         y->color = z->color;
     }
-    delete z;
+    // Every node whose subtree lost z lies on the path from x's parent up.
+    recomputeUpward(x->parent);
+
+    deptIndex.remove(z->id, records.getDeptCode(z->record));
+    gpaIndex.remove(z->id, records.getGpa(z->record));
+    nameIndex.remove(z->id, records.getName(z->record));
+    records.remove(z->record);
+    pool.destroy(z);
     if (y_original_color == BLACK) {
         fixDelete(x);
     }
+    return true;
 }
 
 void RBTree::fixInsert(RBTree::Node *k) {
     Node *u;
     while (k->parent->color == RED) {
+        METRIC_COUNT(INSERT_FIXUP_STEPS);
         if (k->parent == k->parent->parent->right) {
             u = k->parent->parent->left;
             if (u->color == RED) {
@@ -288,63 +364,638 @@ void RBTree::fixInsert(RBTree::Node *k) {
     root->color = BLACK;
 }
 
-void RBTree::printHelper(RBTree::Node *root, string indent, bool last) {
-    if (root != TNULL) {
-        cout << indent;
-        if (last) {
-            cout << "R----";
-            indent += "   ";
+// Runs node destructors without recursion by unlinking leaves bottom-up.
+// Skipped entirely when Node is trivially destructible; the pool then
+// releases the memory chunk by chunk.
+void RBTree::destroyNodes() {
+    if constexpr (!std::is_trivially_destructible_v<Node>) {
+        Node *node = root;
+        while (node != TNULL) {
+            if (node->left != TNULL) {
+                node = node->left;
+            } else if (node->right != TNULL) {
+                node = node->right;
+            } else {
+                Node *parent = node->parent;
+                if (parent != nullptr) {
+                    if (parent->left == node) {
+                        parent->left = TNULL;
+                    } else {
+                        parent->right = TNULL;
+                    }
+                }
+                node->~Node();
+                node = parent != nullptr ? parent : TNULL;
+            }
+        }
+        TNULL->~Node();
+    }
+    pool.releaseAll();
+}
+
+RBTree::RBTree(size_t nodesPerChunk) : pool(nodesPerChunk) {
+    TNULL = pool.create(0, UINT32_MAX);
+    TNULL->color = BLACK;
+    TNULL->left = nullptr;
+    TNULL->right = nullptr;
+    TNULL->subtree = GpaStats();
+    root = TNULL;
+}
+
+RBTree::RBTree(vector<Student> students, size_t nodesPerChunk) : RBTree(nodesPerChunk) {
+    bulkLoad(std::move(students));
+}
+
+RBTree::~RBTree() {
+    destroyNodes();
+}
+
+void RBTree::clear() {
+    destroyNodes();
+    deptIndex.clear();
+    gpaIndex.clear();
+    nameIndex.clear();
+    records.clear();
+    TNULL = pool.create(0, UINT32_MAX);
+    TNULL->color = BLACK;
+    TNULL->left = nullptr;
+    TNULL->right = nullptr;
+    TNULL->subtree = GpaStats();
+    root = TNULL;
+}
+
+void RBTree::swap(RBTree& other) {
+    pool.swap(other.pool);
+    std::swap(records, other.records);
+    std::swap(root, other.root);
+    std::swap(TNULL, other.TNULL);
+    std::swap(deptIndex, other.deptIndex);
+    std::swap(gpaIndex, other.gpaIndex);
+    std::swap(nameIndex, other.nameIndex);
+}
+
+// Recomputes the augmented fields of node from its children. Called for
+// the two nodes of every rotation and along the path of every insert and
+// delete, which keeps them exact at O(log n) extra work per update.
+void RBTree::recompute(RBTree::Node *node) {
+    node->subtree = node->left->subtree;
+    node->subtree.add(records.getGpa(node->record));
+    node->subtree.merge(node->right->subtree);
+}
+
+void RBTree::recomputeUpward(RBTree::Node *node) {
+    while (node != nullptr) {
+        recompute(node);
+        node = node->parent;
+    }
+}
+
+RBTree::Node *RBTree::successor(RBTree::Node *node) const {
+    if (node->right != TNULL) {
+        node = node->right;
+        while (node->left != TNULL) {
+            node = node->left;
+        }
+        return node;
+    }
+    Node *parent = node->parent;
+    while (parent != nullptr && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent != nullptr ? parent : TNULL;
+}
+
+RBTree::Node *RBTree::predecessor(RBTree::Node *node) const {
+    if (node == TNULL) {
+        // Stepping back from end() lands on the largest ID.
+        node = root;
+        if (node == TNULL) {
+            return TNULL;
+        }
+        while (node->right != TNULL) {
+            node = node->right;
+        }
+        return node;
+    }
+    if (node->left != TNULL) {
+        node = node->left;
+        while (node->right != TNULL) {
+            node = node->right;
+        }
+        return node;
+    }
+    Node *parent = node->parent;
+    while (parent != nullptr && node == parent->left) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent != nullptr ? parent : TNULL;
+}
+
+RBTree::const_iterator::const_iterator() : tree(nullptr), current(nullptr) {}
+
+RBTree::const_iterator::const_iterator(const RBTree *t, RBTree::Node *n) : tree(t), current(n) {}
+
+RBTree::StudentView RBTree::const_iterator::operator*() const {
+    return tree->getStudent(current);
+}
+
+RBTree::const_iterator::ArrowProxy RBTree::const_iterator::operator->() const {
+    return ArrowProxy{tree->getStudent(current)};
+}
+
+RBTree::const_iterator& RBTree::const_iterator::operator++() {
+    current = tree->successor(current);
+    return *this;
+}
+
+RBTree::const_iterator RBTree::const_iterator::operator++(int) {
+    const_iterator old = *this;
+    current = tree->successor(current);
+    return old;
+}
+
+RBTree::const_iterator& RBTree::const_iterator::operator--() {
+    current = tree->predecessor(current);
+    return *this;
+}
+
+RBTree::const_iterator RBTree::const_iterator::operator--(int) {
+    const_iterator old = *this;
+    current = tree->predecessor(current);
+    return old;
+}
+
+bool RBTree::const_iterator::operator==(const const_iterator& other) const {
+    return current == other.current;
+}
+
+bool RBTree::const_iterator::operator!=(const const_iterator& other) const {
+    return current != other.current;
+}
+
+RBTree::Node* RBTree::const_iterator::getNode() const {
+    return current;
+}
+
+RBTree::Range::Range(const_iterator b, const_iterator e) : first(b), last(e) {}
+
+RBTree::const_iterator RBTree::Range::begin() const {
+    return first;
+}
+
+RBTree::const_iterator RBTree::Range::end() const {
+    return last;
+}
+
+bool RBTree::Range::empty() const {
+    return first == last;
+}
+
+// Builds the subtree for records [lo, hi) around the middle one; bulkLoad
+// stores the records in ID order, so record numbers are positions. Every
+// NIL ends up at depth redDepth or redDepth + 1, so coloring the nodes on
+// the deepest level red gives equal black heights without any rotation.
+RBTree::Node *RBTree::buildBalanced(size_t lo, size_t hi, int depth, int redDepth,
+                                    RBTree::Node *parent) {
+    if (lo >= hi) {
+        return TNULL;
+    }
+
+    uint32_t mid = static_cast<uint32_t>(lo + (hi - lo) / 2);
+    Node *node = pool.create(records.getId(mid), mid);
+    node->parent = parent;
+    node->color = (depth == redDepth && depth > 0) ? RED : BLACK;
+    node->left = buildBalanced(lo, mid, depth + 1, redDepth, node);
+    node->right = buildBalanced(mid + 1, hi, depth + 1, redDepth, node);
+    recompute(node);
+    return node;
+}
+
+// Replaces the contents of the tree with the given records in O(n) when they
+// arrive sorted by ID (otherwise after one sort). Only the first record of a
+// repeated ID is kept; the rejected IDs are appended to duplicates. Records
+// with an invalid GPA (see isValidGpa) are dropped and their IDs appended
+// to invalid.
+size_t RBTree::bulkLoad(vector<Student> students, vector<int> *duplicates, vector<int> *invalid) {
+    auto byId = [](const Student& a, const Student& b) { return a.getId() < b.getId(); };
+    if (!is_sorted(students.begin(), students.end(), byId)) {
+        stable_sort(students.begin(), students.end(), byId);
+    }
+    return bulkLoad(students.size(), [&students](size_t i) { return StudentView(students[i]); },
+                    duplicates, invalid);
+}
+
+size_t RBTree::bulkLoad(size_t count, const function<StudentView(size_t)>& row, vector<int> *duplicates,
+                        vector<int> *invalid) {
+    // Positions in ID order, only needed when the rows are not in it.
+    vector<uint32_t> order;
+    for (size_t i = 1; i < count; i++) {
+        if (row(i).getId() < row(i - 1).getId()) {
+            order.resize(count);
+            for (size_t j = 0; j < count; j++) {
+                order[j] = static_cast<uint32_t>(j);
+            }
+            stable_sort(order.begin(), order.end(), [&row](uint32_t a, uint32_t b) {
+                return row(a).getId() < row(b).getId();
+            });
+            break;
+        }
+    }
+
+    clear();
+    size_t nameBytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        nameBytes += row(i).getName().size();
+    }
+    records.reserve(count, nameBytes);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        StudentView student = row(order.empty() ? i : order[i]);
+        if (!isValidGpa(student.getGpa())) {
+            if (invalid != nullptr) {
+                invalid->push_back(student.getId());
+            }
+            continue;
+        }
+        if (kept > 0 && records.getId(static_cast<uint32_t>(kept - 1)) == student.getId()) {
+            if (duplicates != nullptr) {
+                duplicates->push_back(student.getId());
+            }
+            continue;
+        }
+        uint16_t code = deptIndex.intern(student.getDept());
+        records.add(student.getId(), student.getName(), code, student.getGpa());
+        deptIndex.add(student.getId(), code);
+        gpaIndex.add(student.getId(), student.getGpa());
+        nameIndex.add(student.getId(), student.getName());
+        kept++;
+    }
+
+    int redDepth = 0;
+    while ((size_t(2) << redDepth) <= kept) {
+        redDepth++;
+    }
+    root = buildBalanced(0, kept, 0, redDepth, nullptr);
+    METRIC_ADD(BULK_LOADED, kept);
+    return kept;
+}
+
+// Returns the black height of the subtree, or -1 if any red-black or BST
+// property is violated below node.
+int RBTree::validateHelper(RBTree::Node *node, RBTree::Node *parent, long long lo, long long hi) const {
+    if (node == TNULL) {
+        return 1;
+    }
+    if (node->parent != parent) {
+        return -1;
+    }
+    long long id = node->id;
+    if (id < lo || id > hi || records.getId(node->record) != node->id) {
+        return -1;
+    }
+    if (node->color == RED && (node->left->color == RED || node->right->color == RED)) {
+        return -1;
+    }
+
+    int leftHeight = validateHelper(node->left, node, lo, id - 1);
+    int rightHeight = validateHelper(node->right, node, id + 1, hi);
+    if (leftHeight < 0 || leftHeight != rightHeight) {
+        return -1;
+    }
+    const GpaStats& l = node->left->subtree;
+    const GpaStats& r = node->right->subtree;
+    double gpa = records.getGpa(node->record);
+    if (node->subtree.count != l.count + r.count + 1
+        || node->subtree.min != std::min({l.min, gpa, r.min})
+        || node->subtree.max != std::max({l.max, gpa, r.max})) {
+        return -1;
+    }
+    return leftHeight + (node->color == BLACK ? 1 : 0);
+}
+
+bool RBTree::validate() const {
+    if (root != TNULL && (root->color != BLACK || root->parent != nullptr)) {
+        return false;
+    }
+    return validateHelper(root, nullptr, LLONG_MIN, LLONG_MAX) > 0 && records.size() == size();
+}
+
+RBTree::const_iterator RBTree::begin() const {
+    Node *node = root;
+    if (node != TNULL) {
+        while (node->left != TNULL) {
+            node = node->left;
+        }
+    }
+    return const_iterator(this, node);
+}
+
+RBTree::const_iterator RBTree::end() const {
+    return const_iterator(this, TNULL);
+}
+
+// First student whose ID is >= id.
+RBTree::const_iterator RBTree::lower_bound(int id) const {
+    Node *node = root;
+    Node *result = TNULL;
+    while (node != TNULL) {
+        if (node->id >= id) {
+            result = node;
+            node = node->left;
         } else {
-            cout << "L----";
-            indent += "|  ";
+            node = node->right;
         }
+    }
+    return const_iterator(this, result);
+}
 
-        string sColor = root->color ? "RED" : "BLACK";
-        cout << root->data.getId() << "(" << sColor << ")" << endl;
-        printHelper(root->left, indent, false);
-        printHelper(root->right, indent, true);
+// First student whose ID is > id.
+RBTree::const_iterator RBTree::upper_bound(int id) const {
+    Node *node = root;
+    Node *result = TNULL;
+    while (node != TNULL) {
+        if (node->id > id) {
+            result = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return const_iterator(this, result);
+}
+
+RBTree::Node *RBTree::findNode(int id) const {
+    Node *node = root;
+    while (node != TNULL && node->id != id) {
+        node = id < node->id ? node->left : node->right;
     }
+    return node;
 }
 
-void RBTree::rangeQueryHelper(RBTree::Node *node, int minID, int maxID) {
+RBTree::const_iterator RBTree::find(int id) const {
+    METRIC_TIME(LOOKUP_TIMER);
+    Node *node = findNode(id);
+    METRIC_COUNT(LOOKUPS);
     if (node == TNULL) {
-        return;
+        METRIC_COUNT(MISSED_LOOKUPS);
     }
+    return const_iterator(this, node);
+}
 
-    if (node->data.getId() > minID) {
-        rangeQueryHelper(node->left, minID, maxID);
+// All students with minID <= ID <= maxID, in ID order. The timer covers
+// finding the bounds; the walk happens in the caller.
+RBTree::Range RBTree::range(int minID, int maxID) const {
+    METRIC_COUNT(RANGE_QUERIES);
+    METRIC_TIME(RANGE_TIMER);
+    if (minID > maxID) {
+        return Range(end(), end());
     }
+    return Range(lower_bound(minID), upper_bound(maxID));
+}
 
-    if (node->data.getId() >= minID && node->data.getId() <= maxID) {
-        cout << "ID: " << node->data.getId() 
-             << " | Name: " << node->data.getName() 
-             << " | Dept: " << node->data.getDept() 
-             << " | GPA: " << fixed << setprecision(2) << node->data.getGpa() << endl;
+size_t RBTree::rank(int id) const {
+    size_t smaller = 0;
+    Node *node = root;
+    while (node != TNULL) {
+        if (node->id < id) {
+            smaller += node->left->subtree.count + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
     }
+    return smaller;
+}
 
-    if (node->data.getId() < maxID) {
-        rangeQueryHelper(node->right, minID, maxID);
+RBTree::const_iterator RBTree::select(size_t k) const {
+    Node *node = root;
+    while (node != TNULL) {
+        size_t leftSize = node->left->subtree.count;
+        if (k < leftSize) {
+            node = node->left;
+        } else if (k == leftSize) {
+            break;
+        } else {
+            k -= leftSize + 1;
+            node = node->right;
+        }
     }
+    return const_iterator(this, node);
 }
 
-RBTree::RBTree() {
-    TNULL = new Node(Student());
-    TNULL->color = BLACK;
-    TNULL->left = nullptr;
-    TNULL->right = nullptr;
-    root = TNULL;
+size_t RBTree::countRange(int minID, int maxID) const {
+    METRIC_COUNT(RANGE_QUERIES);
+    if (minID > maxID) {
+        return 0;
+    }
+    size_t upTo = maxID == INT_MAX ? size() : rank(maxID + 1);
+    return upTo - rank(minID);
+}
+
+// Descends to the highest node inside [minID, maxID], then follows the two
+// boundary paths below it. On the left path every node >= minID brings its
+// whole right subtree along, on the right path every node <= maxID brings
+// its left subtree, so at most O(log n) summaries are merged.
+RBTree::GpaStats RBTree::rangeStats(int minID, int maxID) const {
+    METRIC_COUNT(RANGE_QUERIES);
+    GpaStats stats;
+    Node *split = root;
+    while (split != TNULL) {
+        int id = split->id;
+        if (id < minID) {
+            split = split->right;
+        } else if (id > maxID) {
+            split = split->left;
+        } else {
+            break;
+        }
+    }
+    if (split == TNULL) {
+        return stats;
+    }
+    stats.add(records.getGpa(split->record));
+
+    for (Node *node = split->left; node != TNULL; ) {
+        if (node->id >= minID) {
+            stats.add(records.getGpa(node->record));
+            stats.merge(node->right->subtree);
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    for (Node *node = split->right; node != TNULL; ) {
+        if (node->id <= maxID) {
+            stats.add(records.getGpa(node->record));
+            stats.merge(node->left->subtree);
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return stats;
+}
+
+const DepartmentIndex& RBTree::getDepartmentIndex() const {
+    return deptIndex;
+}
+
+size_t RBTree::countInDepartment(string_view dept) const {
+    return deptIndex.countIn(dept);
+}
+
+const GpaIndex& RBTree::getGpaIndex() const {
+    return gpaIndex;
+}
+
+// Returns false when id is not in the tree or gpa is not valid.
+bool RBTree::updateGpa(int id, double gpa) {
+    if (!isValidGpa(gpa)) {
+        return false;
+    }
+    Node *node = find(id).getNode();
+    if (node == TNULL) {
+        return false;
+    }
+    gpaIndex.remove(id, records.getGpa(node->record));
+    records.setGpa(node->record, gpa);
+    gpaIndex.add(id, gpa);
+    recomputeUpward(node);
+    return true;
+}
+
+vector<RBTree::StudentView> RBTree::topK(size_t k) const {
+    vector<StudentView> result;
+    const set<GpaIndex::Entry>& entries = gpaIndex.getEntries();
+    result.reserve(std::min(k, entries.size()));
+    for (auto it = entries.rbegin(); it != entries.rend() && result.size() < k; ++it) {
+        result.push_back(getStudent(findNode(it->second)));
+    }
+    return result;
+}
+
+vector<RBTree::StudentView> RBTree::gpaRange(double lo, double hi) const {
+    vector<StudentView> result;
+    if (lo > hi) {
+        return result;
+    }
+    auto last = gpaIndex.upperBound(hi);
+    for (auto it = gpaIndex.lowerBound(lo); it != last; ++it) {
+        result.push_back(getStudent(findNode(it->second)));
+    }
+    return result;
+}
+
+double RBTree::percentile(double p) const {
+    size_t n = gpaIndex.size();
+    if (n == 0) {
+        return 0.0;
+    }
+    double rank = ceil(p / 100.0 * double(n));
+    size_t k = !(rank > 1.0) ? 0 : rank >= double(n) ? n - 1 : size_t(rank) - 1;
+    return gpaIndex.kthLowest(k);
+}
+
+const NameIndex& RBTree::getNameIndex() const {
+    return nameIndex;
+}
+
+vector<RBTree::StudentView> RBTree::searchNamePrefix(string_view prefix, size_t limit) const {
+    vector<StudentView> result;
+    for (int id : nameIndex.prefixMatches(prefix, limit)) {
+        result.push_back(getStudent(findNode(id)));
+    }
+    return result;
+}
+
+// The trigram candidates only guarantee that the pieces occur somewhere in
+// the name, so each one is checked against the name itself. Queries under
+// three characters have no trigrams and fall back to a full scan.
+vector<RBTree::StudentView> RBTree::searchNameContaining(string_view text, size_t limit) const {
+    vector<StudentView> result;
+    string folded = NameIndex::fold(text);
+    auto matches = [&folded](const StudentView& student) {
+        return NameIndex::fold(student.getName()).find(folded) != string::npos;
+    };
+
+    if (limit == 0) {
+        return result;
+    }
+    bool indexed = nameIndex.forEachSubstringCandidate(folded, [&](int id) {
+        StudentView student = getStudent(findNode(id));
+        if (matches(student)) {
+            result.push_back(student);
+        }
+        return result.size() < limit;
+    });
+    if (!indexed) {
+        for (const_iterator it = begin(); it != end() && result.size() < limit; ++it) {
+            StudentView student = *it;
+            if (matches(student)) {
+                result.push_back(student);
+            }
+        }
+    }
+    return result;
+}
+
+size_t RBTree::size() const {
+    return root->subtree.count;
+}
+
+int RBTree::height() const {
+    int height = 0;
+    forEachPreOrder([&height](const Node *, int depth) { height = max(height, depth + 1); });
+    return height;
+}
+
+int RBTree::blackHeight() const {
+    int black = 0;
+    for (const Node *node = root; node != TNULL; node = node->left) {
+        black += node->color == BLACK;
+    }
+    return black;
+}
+
+RBTree::MemoryReport RBTree::memoryUsage() const {
+    MemoryReport report;
+    report.students = size();
+    report.nodeBytes = pool.bytesReserved();
+    report.recordBytes = records.columnBytes();
+    report.nameBytes = records.arenaBytes();
+    report.indexBytes = deptIndex.approximateBytes() + gpaIndex.approximateBytes()
+                        + nameIndex.approximateBytes();
+    return report;
 }
 
 void RBTree::preorder() {
-    preOrderHelper(this->root);
+    forEachPreOrder([](const Node *node, int) {
+        cout << node->id << " ";
+    });
 }
 
 void RBTree::inorder() {
-    inOrderHelper(this->root);
+    forEach(printStudent);
 }
 
 RBTree::Node *RBTree::searchTree(int k) {
-    return searchTreeHelper(this->root, k);
+    METRIC_TIME(LOOKUP_TIMER);
+    Node *node = root;
+    while (node != TNULL && node->id != k) {
+        node = k < node->id ? node->left : node->right;
+    }
+    METRIC_COUNT(LOOKUPS);
+    if (node == TNULL) {
+        METRIC_COUNT(MISSED_LOOKUPS);
+    }
+    return node;
+}
+
+bool RBTree::isNil(const Node *node) const {
+    return node == nullptr || node == TNULL;
 }
 
 RBTree::Node *RBTree::minimum(RBTree::Node *node) {
@@ -362,6 +1013,7 @@ RBTree::Node *RBTree::maximum(RBTree::Node *node) {
 }
 
 void RBTree::leftRotate(RBTree::Node *x) {
+    METRIC_COUNT(LEFT_ROTATIONS);
     Node *y = x->right;
     x->right = y->left;
     if (y->left != TNULL) {
@@ -377,9 +1029,12 @@ void RBTree::leftRotate(RBTree::Node *x) {
     }
     y->left = x;
     x->parent = y;
+    recompute(x);
+    recompute(y);
 }
 
 void RBTree::rightRotate(RBTree::Node *x) {
+    METRIC_COUNT(RIGHT_ROTATIONS);
     Node *y = x->left;
     x->left = y->right;
     if (y->right != TNULL) {
@@ -395,64 +1050,120 @@ void RBTree::rightRotate(RBTree::Node *x) {
     }
     y->right = x;
     x->parent = y;
+    recompute(x);
+    recompute(y);
 }
 
-void RBTree::insert(int id, string name, string dept, double gpa) {
-    Node *node = new Node(Student(id, name, dept, gpa));
-    node->parent = nullptr;
-    node->left = TNULL;
-    node->right = TNULL;
-    node->color = RED;
+bool RBTree::insert(int id, string_view name, string_view dept, double gpa) {
+    return insertRecord(id, name, dept, gpa);
+}
+
+bool RBTree::insert(const Student& student) {
+    return insertRecord(student.getId(), student.getName(), student.getDept(), student.getGpa());
+}
 
+bool RBTree::isValidGpa(double gpa) {
+    return isfinite(gpa) && gpa >= 0.0 && gpa <= 4.0;
+}
+
+// Returns false without modifying the tree if the ID is already taken or
+// the GPA is not valid. The strings are copied into the record table, so
+// the caller keeps them.
+bool RBTree::insertRecord(int id, string_view name, string_view dept, double gpa) {
+    METRIC_TIME(INSERT_TIMER);
+    METRIC_COUNT(INSERTS);
+    if (!isValidGpa(gpa)) {
+        return false;
+    }
     Node *y = nullptr;
     Node *x = this->root;
 
+    // Find the parent first so a duplicate ID never costs an allocation.
     while (x != TNULL) {
         y = x;
-        if (node->data.getId() < x->data.getId()) {
+        if (id < x->id) {
             x = x->left;
-        } else if (node->data.getId() > x->data.getId()) {
+        } else if (id > x->id) {
             x = x->right;
         } else {
-            cout << "Error: Student with ID " << id << " already exists.\n";
-            delete node;
-            return;
+            METRIC_COUNT(DUPLICATE_INSERTS);
+            return false;
         }
     }
 
+    uint16_t code = deptIndex.intern(dept);
+    Node *node = pool.create(id, records.add(id, name, code, gpa));
+    node->left = TNULL;
+    node->right = TNULL;
+    node->color = RED;
+    recompute(node);
+
     node->parent = y;
     if (y == nullptr) {
         root = node;
-    } else if (node->data.getId() < y->data.getId()) {
+    } else if (node->id < y->id) {
         y->left = node;
     } else {
         y->right = node;
     }
+    deptIndex.add(id, code);
+    gpaIndex.add(id, gpa);
+    nameIndex.add(id, name);
+    recomputeUpward(y);
 
     if (node->parent == nullptr) {
         node->color = BLACK;
-        return;
+        return true;
     }
 
     if (node->parent->parent == nullptr) {
-        return;
+        return true;
     }
 
     fixInsert(node);
+    return true;
 }
 
 RBTree::Node *RBTree::getRoot() {
     return this->root;
 }
 
-void RBTree::deleteNode(int id) {
-    deleteNodeHelper(this->root, id);
+const RBTree::Node *RBTree::getRoot() const {
+    return this->root;
 }
 
-void RBTree::printTree() {
-    if (root) {
-        printHelper(this->root, "", true);
+RBTree::StudentView RBTree::getStudent(const Node *node) const {
+    uint32_t row = node->record;
+    uint16_t code = records.getDeptCode(row);
+    return StudentView(node->id, records.getName(row), deptIndex.getName(code),
+                       records.getGpa(row), code);
+}
+
+bool RBTree::deleteNode(int id) {
+    METRIC_TIME(DELETE_TIMER);
+    bool deleted = deleteNodeHelper(this->root, id);
+    METRIC_COUNT(DELETES);
+    if (!deleted) {
+        METRIC_COUNT(MISSED_DELETES);
     }
+    return deleted;
+}
+
+// One line per node, children indented under their parent. The indent
+// buffer is truncated to the node's depth instead of being copied per level.
+void RBTree::printTree(int maxDepth) {
+    string indent;
+    forEachPreOrder(maxDepth, [&indent, maxDepth](const Node *node, int depth) {
+        bool last = node->parent == nullptr || node == node->parent->right;
+        indent.resize(size_t(depth) * 3);
+        cout << indent << (last ? "R----" : "L----")
+             << node->id << "(" << (node->color == RED ? "RED" : "BLACK") << ")";
+        if (depth == maxDepth && node->getSize() > 1) {
+            cout << " ... " << node->getSize() - 1 << " more";
+        }
+        cout << "\n";
+        indent += last ? "   " : "|  ";
+    });
 }
 
 void RBTree::search(int id) {
@@ -461,14 +1172,14 @@ void RBTree::search(int id) {
         cout << "Student with ID " << id << " not found.\n";
     } else {
         cout << "\n--- Student Found ---\n";
-        cout << "ID: " << result->data.getId() << endl;
-        cout << "Name: " << result->data.getName() << endl;
-        cout << "Department: " << result->data.getDept() << endl;
-        cout << "GPA: " << fixed << setprecision(2) << result->data.getGpa() << endl;
+        cout << "ID: " << result->id << endl;
+        cout << "Name: " << records.getName(result->record) << endl;
+        cout << "Department: " << deptIndex.getName(records.getDeptCode(result->record)) << endl;
+        cout << "GPA: " << fixed << setprecision(2) << records.getGpa(result->record) << endl;
     }
 }
 
 void RBTree::printRange(int minID, int maxID) {
     cout << "\n--- Students with IDs from " << minID << " to " << maxID << " ---\n";
-    rangeQueryHelper(this->root, minID, maxID);
+    forEachInRange(minID, maxID, printStudent);
 }
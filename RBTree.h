@@ -1,7 +1,20 @@
 #ifndef RBTREE_H
 #define RBTREE_H
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "DepartmentIndex.h"
+#include "GpaIndex.h"
+#include "Metrics.h"
+#include "NameIndex.h"
+#include "NodePool.h"
+#include "RecordTable.h"
 
 enum Color { RED, BLACK };
 
@@ -19,8 +32,8 @@ public:
         Student(int i, std::string n, std::string d, double g);
         
         int getId() const;
-        std::string getName() const;
-        std::string getDept() const;
+        std::string_view getName() const;
+        std::string_view getDept() const;
         double getGpa() const;
         
         void setId(int i);
@@ -29,24 +42,72 @@ public:
         void setGpa(double g);
     };
 
+    // Read-only view of one stored student, as handed out by iterators and
+    // queries. The strings point into the tree's record storage, so like an
+    // iterator a view is invalidated by the next insert or delete.
+    // getDeptCode() is the tree's DepartmentIndex code, for filtering by
+    // department with an integer compare; views made from a Student have
+    // NO_DEPARTMENT.
+    class StudentView {
+    private:
+        int id;
+        std::string_view name;
+        std::string_view dept;
+        double gpa;
+        uint16_t deptCode;
+
+    public:
+        StudentView(int i, std::string_view n, std::string_view d, double g,
+                    uint16_t code = DepartmentIndex::NO_DEPARTMENT);
+        StudentView(const Student& s);
+
+        int getId() const;
+        std::string_view getName() const;
+        std::string_view getDept() const;
+        uint16_t getDeptCode() const;
+        double getGpa() const;
+        Student toStudent() const;
+    };
+
+    // GPA summary over a set of students; see rangeStats().
+    struct GpaStats {
+        std::size_t count;
+        double sum;
+        double sumSquares;
+        double min;     // +inf when count == 0
+        double max;     // -inf when count == 0
+
+        GpaStats();
+        void add(double gpa);
+        void merge(const GpaStats& other);
+        double mean() const;
+        double stddev() const;   // population standard deviation
+    };
+
+    // Nodes carry only the key and the row of the record in the tree's
+    // RecordTable, so a search touches IDs and links, never names.
     class Node {
     private:
-        Student data;
+        int id;
+        uint32_t record;
         Color color;
         Node *left;
         Node *right;
         Node *parent;
+        GpaStats subtree;   // summary of the subtree rooted here (empty for TNULL)
 
     public:
-        Node(Student s);
+        Node(int key, uint32_t row);
         
-        Student getData() const;
+        int getId() const;
+        uint32_t getRecord() const;
         Color getColor() const;
         Node* getLeft() const;
         Node* getRight() const;
         Node* getParent() const;
+        std::size_t getSize() const;
+        const GpaStats& getSubtreeStats() const;
         
-        void setData(const Student& s);
         void setColor(Color c);
         void setLeft(Node* node);
         void setRight(Node* node);
@@ -55,23 +116,105 @@ public:
         friend class RBTree;
     };
 
+    // Bidirectional in-order iterator. Steps through parent pointers, so a
+    // scan needs no recursion and no extra memory; it is invalidated by any
+    // insert or delete on the tree.
+    class const_iterator {
+    private:
+        const RBTree *tree;
+        Node *current;
+
+        const_iterator(const RBTree *t, Node *n);
+
+    public:
+        // Views are built on the fly, so operator-> hands out a small
+        // holder for one instead of a pointer into the tree.
+        struct ArrowProxy {
+            StudentView view;
+            const StudentView *operator->() const { return &view; }
+        };
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = StudentView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ArrowProxy;
+        using reference = StudentView;
+
+        const_iterator();
+
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        const_iterator& operator--();
+        const_iterator operator--(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+        Node* getNode() const;
+
+        friend class RBTree;
+    };
+
+    using iterator = const_iterator;
+
+    // Half-open [begin, end) view returned by range(); usable in range-for.
+    class Range {
+    private:
+        const_iterator first;
+        const_iterator last;
+
+    public:
+        Range(const_iterator b, const_iterator e);
+        const_iterator begin() const;
+        const_iterator end() const;
+        bool empty() const;
+    };
+
+    // Bytes held by one tree, by part; see memoryUsage().
+    struct MemoryReport {
+        std::size_t students;
+        std::size_t nodeBytes;      // node pool chunks
+        std::size_t recordBytes;    // record columns
+        std::size_t nameBytes;      // name arena
+        std::size_t indexBytes;     // department, GPA and name indexes (estimated)
+
+        std::size_t total() const;
+        double bytesPerStudent() const;
+    };
+
 private:
+    NodePool<Node> pool;
+    RecordTable records;
     Node *root;
     Node *TNULL;
+    DepartmentIndex deptIndex;
+    GpaIndex gpaIndex;
+    NameIndex nameIndex;
 
     void initializeNULLNode(Node *node, Node *parent);
-    void preOrderHelper(Node *node);
-    void inOrderHelper(Node *node);
-    Node *searchTreeHelper(Node *node, int key);
     void fixDelete(Node *x);
     void rbTransplant(Node *u, Node *v);
-    void deleteNodeHelper(Node *node, int key);
+    bool deleteNodeHelper(Node *node, int key);
     void fixInsert(Node *k);
-    void printHelper(Node *root, std::string indent, bool last);
-    void rangeQueryHelper(Node *node, int minID, int maxID);
+    void destroyNodes();
+    Node *buildBalanced(std::size_t lo, std::size_t hi, int depth, int redDepth, Node *parent);
+    bool insertRecord(int id, std::string_view name, std::string_view dept, double gpa);
+    void recompute(Node *node);
+    void recomputeUpward(Node *node);
+    Node *successor(Node *node) const;
+    Node *predecessor(Node *node) const;
+    // find() without the lookup metrics, for resolving index hits.
+    Node *findNode(int id) const;
+    int validateHelper(Node *node, Node *parent, long long lo, long long hi) const;
 
 public:
-    RBTree();
+    explicit RBTree(std::size_t nodesPerChunk = 4096);
+    explicit RBTree(std::vector<Student> students, std::size_t nodesPerChunk = 4096);
+    ~RBTree();
+    RBTree(const RBTree&) = delete;
+    RBTree& operator=(const RBTree&) = delete;
+
     void preorder();
     void inorder();
     Node *searchTree(int k);
@@ -79,12 +222,150 @@ public:
     Node *maximum(Node *node);
     void leftRotate(Node *x);
     void rightRotate(Node *x);
-    void insert(int id, std::string name, std::string dept, double gpa);
+    // GPAs must be finite and within 0.00 - 4.00: insert, updateGpa and
+    // bulkLoad reject anything else (a NaN would break the GPA index's
+    // ordering).
+    static bool isValidGpa(double gpa);
+    bool insert(int id, std::string_view name, std::string_view dept, double gpa);
+    bool insert(const Student& student);
     Node *getRoot();
-    void deleteNode(int id);
-    void printTree();
+    const Node *getRoot() const;
+    // True for the NIL sentinel (and nullptr); use this rather than
+    // checking for ID 0, which is a valid student ID.
+    bool isNil(const Node *node) const;
+    StudentView getStudent(const Node *node) const;
+    bool deleteNode(int id);
+    // Prints levels 0 .. maxDepth (the root is level 0); a node on the last
+    // level with students below it shows how many were left out.
+    void printTree(int maxDepth = INT_MAX);
     void search(int id);
     void printRange(int minID, int maxID);
+    void clear();
+    // Exchanges contents with other in O(1); nodes, records and views keep
+    // their addresses but now belong to the other tree.
+    void swap(RBTree& other);
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator lower_bound(int id) const;
+    const_iterator upper_bound(int id) const;
+    const_iterator find(int id) const;
+    Range range(int minID, int maxID) const;
+
+    // Visitor API. The walks follow parent pointers, so they use no
+    // recursion, no stack and no allocation whatever the tree depth.
+    // forEach and forEachInRange call visit(const StudentView&) in ID
+    // order; forEachPreOrder calls visit(const Node*, int depth) for every
+    // node, parent before children and left before right. Given maxDepth,
+    // it stops at that depth (the root is 0) without touching the nodes
+    // below, so showing the top levels of a huge tree is cheap.
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const_iterator it = begin(); it != end(); ++it) {
+            visit(*it);
+        }
+    }
+
+    template <typename Visitor>
+    void forEachInRange(int minID, int maxID, Visitor visit) const {
+        METRIC_COUNT(RANGE_QUERIES);
+        METRIC_TIME(RANGE_TIMER);
+        if (minID > maxID) {
+            return;
+        }
+        for (const_iterator it = lower_bound(minID); it != end() && it.current->id <= maxID; ++it) {
+            visit(*it);
+        }
+    }
+
+    template <typename Visitor>
+    void forEachPreOrder(Visitor visit) const {
+        forEachPreOrder(INT_MAX, visit);
+    }
+
+    template <typename Visitor>
+    void forEachPreOrder(int maxDepth, Visitor visit) const {
+        const Node *node = root;
+        int depth = 0;
+        while (node != TNULL && depth <= maxDepth) {
+            visit(node, depth);
+            if (depth < maxDepth && node->left != TNULL) {
+                node = node->left;
+                depth++;
+            } else if (depth < maxDepth && node->right != TNULL) {
+                node = node->right;
+                depth++;
+            } else {
+                // Climb to the nearest ancestor with an unvisited right
+                // subtree; its right child is as deep as the node we left.
+                const Node *parent = node->parent;
+                while (parent != nullptr && (node == parent->right || parent->right == TNULL)) {
+                    node = parent;
+                    parent = parent->parent;
+                    depth--;
+                }
+                node = parent != nullptr ? parent->right : TNULL;
+            }
+        }
+    }
+
+    // Order statistics from the subtree sizes, all O(log n).
+    // rank(id) is the number of students with a smaller ID, i.e. the 0-based
+    // position id has (or would have) in sorted order; select(k) is the
+    // student at position k, or end() when k >= size().
+    std::size_t rank(int id) const;
+    const_iterator select(std::size_t k) const;
+    std::size_t countRange(int minID, int maxID) const;
+    // Count, mean, standard deviation, min and max of the GPAs with
+    // minID <= ID <= maxID, merged from O(log n) subtree summaries.
+    GpaStats rangeStats(int minID, int maxID) const;
+
+    // Department roster queries, answered from the secondary index that
+    // insert/deleteNode/bulkLoad keep up to date.
+    const DepartmentIndex& getDepartmentIndex() const;
+    std::size_t countInDepartment(std::string_view dept) const;
+
+    template <typename Visitor>
+    void forEachInDepartment(std::string_view dept, Visitor visit) const {
+        for (int id : deptIndex.studentsIn(dept)) {
+            visit(getStudent(findNode(id)));
+        }
+    }
+
+    // GPA-ordered queries from the (gpa, id) index that insert, deleteNode,
+    // updateGpa and bulkLoad keep in step with the tree. topK lists the
+    // highest GPAs first (equal GPAs by descending ID), gpaRange the lowest
+    // first. percentile(p) is the nearest-rank p-th percentile GPA,
+    // 0 <= p <= 100, or 0 for an empty tree.
+    const GpaIndex& getGpaIndex() const;
+    bool updateGpa(int id, double gpa);
+    std::vector<StudentView> topK(std::size_t k) const;
+    std::vector<StudentView> gpaRange(double lo, double hi) const;
+    double percentile(double p) const;
+
+    // Case-insensitive name search from the name index. searchNamePrefix
+    // matches the start of any word of a name ("smi" finds "John Smith"),
+    // ordered by the matching word; searchNameContaining matches anywhere
+    // in the name, ordered by ID. Both stop after limit students.
+    const NameIndex& getNameIndex() const;
+    std::vector<StudentView> searchNamePrefix(std::string_view prefix,
+                                              std::size_t limit = SIZE_MAX) const;
+    std::vector<StudentView> searchNameContaining(std::string_view text,
+                                                  std::size_t limit = SIZE_MAX) const;
+
+    std::size_t bulkLoad(std::vector<Student> students, std::vector<int> *duplicates = nullptr,
+                         std::vector<int> *invalid = nullptr);
+    // The same for count students kept elsewhere, e.g. in a mapped file:
+    // row(i) returns the i-th, and its strings are copied straight into the
+    // record table, so no Student is built.
+    std::size_t bulkLoad(std::size_t count, const std::function<StudentView(std::size_t)>& row,
+                         std::vector<int> *duplicates = nullptr, std::vector<int> *invalid = nullptr);
+    bool validate() const;
+    std::size_t size() const;
+    // Longest root-to-leaf path in nodes (0 when empty), found by walking
+    // every node; black nodes on any root-to-leaf path, excluding NIL.
+    int height() const;
+    int blackHeight() const;
+    MemoryReport memoryUsage() const;
 };
 
 #endif
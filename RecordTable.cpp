@@ -0,0 +1,91 @@
+#include "RecordTable.h"
+#include <stdexcept>
+
+using namespace std;
+
+RecordTable::RecordTable() : deadNameBytes(0) {}
+
+uint32_t RecordTable::add(int id, string_view name, uint16_t deptCode, double gpa) {
+    if (nameArena.size() + name.size() > UINT32_MAX) {
+        throw length_error("RecordTable: name arena is limited to 4 GiB");
+    }
+    uint32_t offset = static_cast<uint32_t>(nameArena.size());
+    nameArena.insert(nameArena.end(), name.begin(), name.end());
+
+    if (!freeRecords.empty()) {
+        uint32_t record = freeRecords.back();
+        freeRecords.pop_back();
+        ids[record] = id;
+        gpas[record] = gpa;
+        deptCodes[record] = deptCode;
+        nameOffsets[record] = offset;
+        nameLengths[record] = static_cast<uint32_t>(name.size());
+        return record;
+    }
+    ids.push_back(id);
+    gpas.push_back(gpa);
+    deptCodes.push_back(deptCode);
+    nameOffsets.push_back(offset);
+    nameLengths.push_back(static_cast<uint32_t>(name.size()));
+    return static_cast<uint32_t>(ids.size() - 1);
+}
+
+void RecordTable::remove(uint32_t record) {
+    deadNameBytes += nameLengths[record];
+    nameLengths[record] = 0;
+    freeRecords.push_back(record);
+    if (freeRecords.size() == ids.size()) {
+        clear();
+    } else if (deadNameBytes > 4096 && deadNameBytes * 2 > nameArena.size()) {
+        compactNames();
+    }
+}
+
+// Copies the live names into a fresh arena in record order. Removed records
+// have length 0, so they simply drop out.
+void RecordTable::compactNames() {
+    vector<char> packed;
+    packed.reserve(nameArena.size() - deadNameBytes);
+    for (size_t record = 0; record < ids.size(); record++) {
+        uint32_t offset = static_cast<uint32_t>(packed.size());
+        const char *name = nameArena.data() + nameOffsets[record];
+        packed.insert(packed.end(), name, name + nameLengths[record]);
+        nameOffsets[record] = offset;
+    }
+    nameArena.swap(packed);
+    deadNameBytes = 0;
+}
+
+void RecordTable::clear() {
+    ids.clear();
+    gpas.clear();
+    deptCodes.clear();
+    nameOffsets.clear();
+    nameLengths.clear();
+    nameArena.clear();
+    freeRecords.clear();
+    deadNameBytes = 0;
+}
+
+void RecordTable::reserve(size_t records, size_t nameBytes) {
+    ids.reserve(records);
+    gpas.reserve(records);
+    deptCodes.reserve(records);
+    nameOffsets.reserve(records);
+    nameLengths.reserve(records);
+    nameArena.reserve(nameBytes);
+}
+
+size_t RecordTable::size() const {
+    return ids.size() - freeRecords.size();
+}
+
+size_t RecordTable::columnBytes() const {
+    return ids.capacity() * sizeof(int) + gpas.capacity() * sizeof(double)
+         + deptCodes.capacity() * sizeof(uint16_t)
+         + (nameOffsets.capacity() + nameLengths.capacity() + freeRecords.capacity()) * sizeof(uint32_t);
+}
+
+size_t RecordTable::arenaBytes() const {
+    return nameArena.capacity();
+}
@@ -0,0 +1,55 @@
+#ifndef RECORDTABLE_H
+#define RECORDTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Column store for the student records of an RBTree. Each field lives in
+// its own array indexed by record number, names are packed back to back in
+// one character arena and departments are stored as 16-bit DepartmentIndex
+// codes, so the tree nodes only carry an ID and a record number.
+//
+// Record numbers stay valid until the record is removed; freed numbers are
+// reused by later adds. Names of removed records are reclaimed by
+// compacting the arena once more than half of it is garbage, which moves
+// the characters (invalidating string_views into it) but never renumbers
+// records.
+class RecordTable {
+private:
+    std::vector<int> ids;
+    std::vector<double> gpas;
+    std::vector<uint16_t> deptCodes;
+    std::vector<uint32_t> nameOffsets;
+    std::vector<uint32_t> nameLengths;
+    std::vector<char> nameArena;
+    std::vector<uint32_t> freeRecords;
+    std::size_t deadNameBytes;
+
+    void compactNames();
+
+public:
+    RecordTable();
+
+    uint32_t add(int id, std::string_view name, uint16_t deptCode, double gpa);
+    void remove(uint32_t record);
+    void clear();
+    void reserve(std::size_t records, std::size_t nameBytes);
+
+    int getId(uint32_t record) const { return ids[record]; }
+    double getGpa(uint32_t record) const { return gpas[record]; }
+    uint16_t getDeptCode(uint32_t record) const { return deptCodes[record]; }
+    std::string_view getName(uint32_t record) const {
+        return std::string_view(nameArena.data() + nameOffsets[record], nameLengths[record]);
+    }
+    void setGpa(uint32_t record, double gpa) { gpas[record] = gpa; }
+
+    // Live records, and bytes held by the columns and the arena
+    // (allocated capacity, not just the part in use).
+    std::size_t size() const;
+    std::size_t columnBytes() const;
+    std::size_t arenaBytes() const;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "ShardedSharedMutex.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+ShardedSharedMutex::ShardedSharedMutex(size_t count) : shardCount(count), writerWaiting(false) {
+    if (shardCount == 0) {
+        shardCount = thread::hardware_concurrency();
+        if (shardCount == 0) {
+            shardCount = 8;
+        }
+    }
+    shards = make_unique<Shard[]>(shardCount);
+}
+
+// Threads are numbered round-robin the first time they take a read lock;
+// the number never changes, so unlock_shared() finds the same shard.
+size_t ShardedSharedMutex::readerShard() const {
+    static atomic<size_t> nextThread{0};
+    thread_local size_t threadIndex = nextThread.fetch_add(1, memory_order_relaxed);
+    return threadIndex % shardCount;
+}
+
+// Writers queue on writerGate; writerWaiting stays set until the writer is
+// done so that readers arriving meanwhile wait on the gate instead of
+// slipping in ahead of it.
+void ShardedSharedMutex::lock() {
+    writerGate.lock();
+    writerWaiting.store(true, memory_order_release);
+    for (size_t i = 0; i < shardCount; i++) {
+        shards[i].mutex.lock();
+    }
+}
+
+bool ShardedSharedMutex::try_lock() {
+    if (!writerGate.try_lock()) {
+        return false;
+    }
+    for (size_t i = 0; i < shardCount; i++) {
+        if (!shards[i].mutex.try_lock()) {
+            while (i-- > 0) {
+                shards[i].mutex.unlock();
+            }
+            writerGate.unlock();
+            return false;
+        }
+    }
+    writerWaiting.store(true, memory_order_release);
+    return true;
+}
+
+void ShardedSharedMutex::unlock() {
+    for (size_t i = shardCount; i-- > 0;) {
+        shards[i].mutex.unlock();
+    }
+    writerWaiting.store(false, memory_order_release);
+    writerGate.unlock();
+}
+
+void ShardedSharedMutex::lock_shared() {
+    if (writerWaiting.load(memory_order_acquire)) {
+        // Block until the pending writer has finished.
+        lock_guard<mutex> wait(writerGate);
+    }
+    shards[readerShard()].mutex.lock_shared();
+}
+
+bool ShardedSharedMutex::try_lock_shared() {
+    if (writerWaiting.load(memory_order_acquire)) {
+        return false;
+    }
+    return shards[readerShard()].mutex.try_lock_shared();
+}
+
+void ShardedSharedMutex::unlock_shared() {
+    shards[readerShard()].mutex.unlock_shared();
+}
+
+size_t ShardedSharedMutex::getShardCount() const {
+    return shardCount;
+}
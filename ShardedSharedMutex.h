@@ -0,0 +1,46 @@
+#ifndef SHARDEDSHAREDMUTEX_H
+#define SHARDEDSHAREDMUTEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+// Reader-writer lock built from one std::shared_mutex per shard, each on its
+// own cache line. A reader only locks the shard assigned to its thread, so
+// readers on different cores never bounce a shared counter between them; a
+// writer locks every shard in order. A writer that is waiting holds back new
+// readers, so a steady stream of reads cannot starve it. Meets SharedMutex,
+// so it works with std::shared_lock / std::unique_lock.
+class ShardedSharedMutex {
+private:
+    struct alignas(64) Shard {
+        std::shared_mutex mutex;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    std::size_t shardCount;
+    std::mutex writerGate;
+    alignas(64) std::atomic<bool> writerWaiting;
+
+    std::size_t readerShard() const;
+
+public:
+    // 0 picks one shard per hardware thread.
+    explicit ShardedSharedMutex(std::size_t count = 0);
+    ShardedSharedMutex(const ShardedSharedMutex&) = delete;
+    ShardedSharedMutex& operator=(const ShardedSharedMutex&) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    void lock_shared();
+    bool try_lock_shared();
+    void unlock_shared();
+
+    std::size_t getShardCount() const;
+};
+
+#endif
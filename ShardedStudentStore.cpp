@@ -0,0 +1,175 @@
+#include "ShardedStudentStore.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <queue>
+#include <thread>
+
+using namespace std;
+
+ShardingOptions::ShardingOptions()
+    : shardCount(0), scheme(HASH_PARTITION), minId(0), maxId(INT_MAX), readerLockShards(0) {}
+
+ShardedStudentStore::ShardedStudentStore(const ShardingOptions& shardingOptions) : options(shardingOptions) {
+    if (options.shardCount == 0) {
+        options.shardCount = max(1u, thread::hardware_concurrency());
+    }
+    if (options.maxId < options.minId) {
+        swap(options.minId, options.maxId);
+    }
+    for (size_t i = 0; i < options.shardCount; i++) {
+        shards.push_back(make_unique<ConcurrentRBTree>(options.readerLockShards));
+    }
+}
+
+size_t ShardedStudentStore::shardFor(int id) const {
+    size_t count = shards.size();
+    if (options.scheme == HASH_PARTITION) {
+        // Fibonacci hashing spreads sequential IDs over all shards.
+        uint64_t hash = uint64_t(uint32_t(id)) * 0x9E3779B97F4A7C15ull;
+        return size_t((hash >> 32) % count);
+    }
+    if (id <= options.minId) {
+        return 0;
+    }
+    if (id >= options.maxId) {
+        return count - 1;
+    }
+    uint64_t span = uint64_t(int64_t(options.maxId) - options.minId) + 1;
+    uint64_t offset = uint64_t(int64_t(id) - options.minId);
+    return size_t(offset * count / span);
+}
+
+bool ShardedStudentStore::insert(const RBTree::Student& student) {
+    return insert(student.getId(), student.getName(), student.getDept(), student.getGpa());
+}
+
+bool ShardedStudentStore::insert(int id, string_view name, string_view dept, double gpa) {
+    return shards[shardFor(id)]->insert(id, name, dept, gpa);
+}
+
+bool ShardedStudentStore::deleteNode(int id) {
+    return shards[shardFor(id)]->deleteNode(id);
+}
+
+optional<RBTree::Student> ShardedStudentStore::find(int id) const {
+    return shards[shardFor(id)]->find(id);
+}
+
+bool ShardedStudentStore::contains(int id) const {
+    return shards[shardFor(id)]->contains(id);
+}
+
+size_t ShardedStudentStore::bulkLoad(vector<RBTree::Student> students, vector<int> *duplicates,
+                                     vector<int> *invalid) {
+    vector<vector<RBTree::Student>> parts(shards.size());
+    for (RBTree::Student& student : students) {
+        parts[shardFor(student.getId())].push_back(std::move(student));
+    }
+    students.clear();
+
+    vector<size_t> loaded(shards.size(), 0);
+    vector<vector<int>> rejected(shards.size());
+    vector<vector<int>> badGpas(shards.size());
+    vector<thread> workers;
+    for (size_t i = 0; i < shards.size(); i++) {
+        workers.emplace_back([&, i] {
+            loaded[i] = shards[i]->bulkLoad(std::move(parts[i]), &rejected[i], &badGpas[i]);
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < shards.size(); i++) {
+        total += loaded[i];
+        if (duplicates != nullptr) {
+            duplicates->insert(duplicates->end(), rejected[i].begin(), rejected[i].end());
+        }
+        if (invalid != nullptr) {
+            invalid->insert(invalid->end(), badGpas[i].begin(), badGpas[i].end());
+        }
+    }
+    return total;
+}
+
+// Range partitions are already ordered, so their results are concatenated;
+// hash partitions are merged with a k-way heap over the per-shard results.
+// Each shard is read under its own lock, so the result is consistent per
+// shard but not a single point-in-time view across shards.
+vector<RBTree::Student> ShardedStudentStore::rangeQuery(int minID, int maxID) const {
+    vector<RBTree::Student> result;
+    if (minID > maxID) {
+        return result;
+    }
+
+    if (options.scheme == RANGE_PARTITION) {
+        for (size_t i = shardFor(minID); i <= shardFor(maxID); i++) {
+            shards[i]->forEachInRange(minID, maxID, [&](const RBTree::StudentView& student) {
+                result.push_back(student.toStudent());
+            });
+        }
+        return result;
+    }
+
+    vector<vector<RBTree::Student>> parts;
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        parts.push_back(shard->rangeQuery(minID, maxID));
+        total += parts.back().size();
+    }
+    result.reserve(total);
+
+    using Cursor = pair<int, size_t>;   // (current ID, shard)
+    priority_queue<Cursor, vector<Cursor>, greater<Cursor>> heap;
+    vector<size_t> positions(parts.size(), 0);
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (!parts[i].empty()) {
+            heap.emplace(parts[i][0].getId(), i);
+        }
+    }
+    while (!heap.empty()) {
+        size_t shard = heap.top().second;
+        heap.pop();
+        result.push_back(std::move(parts[shard][positions[shard]++]));
+        if (positions[shard] < parts[shard].size()) {
+            heap.emplace(parts[shard][positions[shard]].getId(), shard);
+        }
+    }
+    return result;
+}
+
+RBTree::GpaStats ShardedStudentStore::rangeStats(int minID, int maxID) const {
+    RBTree::GpaStats stats;
+    if (minID > maxID) {
+        return stats;
+    }
+    size_t first = 0, last = shards.size() - 1;
+    if (options.scheme == RANGE_PARTITION) {
+        first = shardFor(minID);
+        last = shardFor(maxID);
+    }
+    for (size_t i = first; i <= last; i++) {
+        stats.merge(shards[i]->read([&](const RBTree& tree) {
+            return tree.rangeStats(minID, maxID);
+        }));
+    }
+    return stats;
+}
+
+size_t ShardedStudentStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->size();
+    }
+    return total;
+}
+
+size_t ShardedStudentStore::getShardCount() const {
+    return shards.size();
+}
+
+ConcurrentRBTree& ShardedStudentStore::getShard(size_t index) {
+    return *shards[index];
+}
@@ -0,0 +1,61 @@
+#ifndef SHARDEDSTUDENTSTORE_H
+#define SHARDEDSTUDENTSTORE_H
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ConcurrentRBTree.h"
+#include "RBTree.h"
+
+enum PartitionScheme { RANGE_PARTITION, HASH_PARTITION };
+
+struct ShardingOptions {
+    std::size_t shardCount;     // 0 = one per hardware thread
+    PartitionScheme scheme;
+    // RANGE_PARTITION splits [minId, maxId] into equal slices; IDs outside
+    // the span go to the first or last shard.
+    int minId;
+    int maxId;
+    std::size_t readerLockShards;   // passed to each ConcurrentRBTree
+
+    ShardingOptions();
+};
+
+// Student records spread over independent ConcurrentRBTree shards by ID, so
+// writers on different shards never contend on the same root or lock.
+// Point operations go to the owning shard; range queries visit the shards
+// involved and return students in ID order.
+class ShardedStudentStore {
+private:
+    std::vector<std::unique_ptr<ConcurrentRBTree>> shards;
+    ShardingOptions options;
+
+    std::size_t shardFor(int id) const;
+
+public:
+    explicit ShardedStudentStore(const ShardingOptions& shardingOptions = ShardingOptions());
+
+    bool insert(const RBTree::Student& student);
+    bool insert(int id, std::string_view name, std::string_view dept, double gpa);
+    bool deleteNode(int id);
+    std::optional<RBTree::Student> find(int id) const;
+    bool contains(int id) const;
+
+    // Splits the records by shard and bulk-loads every shard on its own
+    // thread, replacing the current contents.
+    std::size_t bulkLoad(std::vector<RBTree::Student> students, std::vector<int> *duplicates = nullptr,
+                         std::vector<int> *invalid = nullptr);
+
+    std::vector<RBTree::Student> rangeQuery(int minID, int maxID) const;
+    // Per-shard summaries merged; like rangeQuery, not a single snapshot.
+    RBTree::GpaStats rangeStats(int minID, int maxID) const;
+    std::size_t size() const;
+
+    std::size_t getShardCount() const;
+    ConcurrentRBTree& getShard(std::size_t index);
+};
+
+#endif
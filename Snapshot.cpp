@@ -0,0 +1,285 @@
+#include "Snapshot.h"
+#include "Checksum.h"
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static_assert(endian::native == endian::little, "snapshot format is little-endian");
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'S', 'T', 'U', 'D', 'S', 'N', 'A', 'P'};
+
+bool fail(string *error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+    return false;
+}
+
+#ifdef _WIN32
+bool syncFile(const string& path) {
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = _commit(fd) == 0;
+    _close(fd);
+    return synced;
+}
+// NTFS journals the rename itself; a directory cannot be flushed here.
+bool syncDirectory(const filesystem::path&) { return true; }
+#else
+bool syncPath(const char *path, int flags) {
+    int fd = ::open(path, flags);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+bool syncFile(const string& path) { return syncPath(path.c_str(), O_RDONLY); }
+bool syncDirectory(const filesystem::path& dir) {
+    return syncPath(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+}
+#endif
+
+// Appends each distinct string to the pool once and hands out its offset.
+class StringInterner {
+private:
+    unordered_map<string_view, uint32_t> offsets;
+
+public:
+    string pool;
+
+    bool intern(string_view text, uint32_t& offset) {
+        auto it = offsets.find(text);
+        if (it != offsets.end()) {
+            offset = it->second;
+            return true;
+        }
+        if (pool.size() + text.size() > UINT32_MAX) {
+            return false;
+        }
+        offset = static_cast<uint32_t>(pool.size());
+        pool.append(text);
+        offsets.emplace(text, offset);
+        return true;
+    }
+};
+
+}
+
+bool Snapshot::save(const RBTree& tree, const string& path, string *error) {
+    vector<SnapshotRecord> records;
+    records.reserve(tree.size());
+    StringInterner interner;
+    // Department strings are already interned by the tree; remember each
+    // code's pool offset so only names go through the hash table.
+    vector<uint32_t> deptOffsets;
+
+    for (RBTree::StudentView student : tree) {
+        string_view name = student.getName();
+        string_view dept = student.getDept();
+        if (name.size() > UINT16_MAX || dept.size() > UINT16_MAX) {
+            return fail(error, "Name or department of student " + to_string(student.getId()) +
+                               " is too long for the snapshot format.");
+        }
+
+        SnapshotRecord record{};
+        record.id = student.getId();
+        record.nameLength = static_cast<uint16_t>(name.size());
+        record.deptLength = static_cast<uint16_t>(dept.size());
+        record.gpa = student.getGpa();
+        uint16_t code = student.getDeptCode();
+        if (code >= deptOffsets.size()) {
+            deptOffsets.resize(size_t(code) + 1, UINT32_MAX);
+        }
+        if (deptOffsets[code] == UINT32_MAX && !interner.intern(dept, deptOffsets[code])) {
+            return fail(error, "String pool exceeds 4 GiB.");
+        }
+        record.deptOffset = deptOffsets[code];
+        if (!interner.intern(name, record.nameOffset)) {
+            return fail(error, "String pool exceeds 4 GiB.");
+        }
+        records.push_back(record);
+    }
+
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.recordCount = records.size();
+    header.recordOffset = sizeof(SnapshotHeader);
+    header.stringPoolOffset = header.recordOffset + records.size() * sizeof(SnapshotRecord);
+    header.stringPoolSize = interner.pool.size();
+    header.recordChecksum = crc32(records.data(), records.size() * sizeof(SnapshotRecord));
+    header.stringPoolChecksum = crc32(interner.pool.data(), interner.pool.size());
+    header.headerChecksum = crc32(&header, offsetof(SnapshotHeader, headerChecksum));
+
+    // Write next to the target, fsync, rename and fsync the directory, so a
+    // crash leaves either the old or the new snapshot under the real name,
+    // and the new one is on disk before the caller (e.g. a checkpoint
+    // truncating its log) relies on it.
+    string tmpPath = path + ".tmp";
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        if (!out) {
+            return fail(error, "Cannot open " + tmpPath + " for writing.");
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<streamsize>(records.size() * sizeof(SnapshotRecord)));
+        out.write(interner.pool.data(), static_cast<streamsize>(interner.pool.size()));
+        out.flush();
+        if (!out) {
+            return fail(error, "Failed while writing " + tmpPath + ".");
+        }
+    }
+
+    if (!syncFile(tmpPath)) {
+        return fail(error, "Cannot sync " + tmpPath + " to disk.");
+    }
+
+    error_code ec;
+    filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        return fail(error, "Cannot replace " + path + ": " + ec.message());
+    }
+    if (!syncDirectory(filesystem::path(path).parent_path())) {
+        return fail(error, "Cannot sync the directory of " + path + " to disk.");
+    }
+    return true;
+}
+
+Snapshot::Snapshot() : header(nullptr), records(nullptr), stringPool(nullptr) {}
+
+bool Snapshot::open(const string& path, bool verifyChecksums, string *error) {
+    close();
+    if (!file.open(path)) {
+        return fail(error, "Cannot open snapshot " + path + ".");
+    }
+
+    const unsigned char *base = file.data();
+    size_t fileSize = file.size();
+    if (fileSize < sizeof(SnapshotHeader)) {
+        close();
+        return fail(error, "Snapshot " + path + " is truncated.");
+    }
+
+    const SnapshotHeader *head = reinterpret_cast<const SnapshotHeader*>(base);
+    if (memcmp(head->magic, SNAPSHOT_MAGIC, sizeof(head->magic)) != 0) {
+        close();
+        return fail(error, path + " is not a student snapshot.");
+    }
+    if (head->version != VERSION || head->headerSize != sizeof(SnapshotHeader)) {
+        close();
+        return fail(error, "Unsupported snapshot version " + to_string(head->version) + ".");
+    }
+    if (crc32(head, offsetof(SnapshotHeader, headerChecksum)) != head->headerChecksum) {
+        close();
+        return fail(error, "Snapshot header checksum mismatch.");
+    }
+
+    uint64_t recordBytes = head->recordCount * sizeof(SnapshotRecord);
+    if (head->recordCount > fileSize / sizeof(SnapshotRecord) ||
+        head->recordOffset > fileSize || recordBytes > fileSize - head->recordOffset ||
+        head->stringPoolOffset > fileSize || head->stringPoolSize > fileSize - head->stringPoolOffset ||
+        head->recordOffset % alignof(SnapshotRecord) != 0) {
+        close();
+        return fail(error, "Snapshot " + path + " is truncated.");
+    }
+
+    const SnapshotRecord *recs = reinterpret_cast<const SnapshotRecord*>(base + head->recordOffset);
+    const char *pool = reinterpret_cast<const char*>(base + head->stringPoolOffset);
+
+    if (verifyChecksums) {
+        if (crc32(recs, recordBytes) != head->recordChecksum ||
+            crc32(pool, head->stringPoolSize) != head->stringPoolChecksum) {
+            close();
+            return fail(error, "Snapshot " + path + " is corrupted (checksum mismatch).");
+        }
+        for (uint64_t i = 0; i < head->recordCount; i++) {
+            if (uint64_t(recs[i].nameOffset) + recs[i].nameLength > head->stringPoolSize ||
+                uint64_t(recs[i].deptOffset) + recs[i].deptLength > head->stringPoolSize) {
+                close();
+                return fail(error, "Snapshot " + path + " has a string outside its pool.");
+            }
+        }
+    }
+
+    header = head;
+    records = recs;
+    stringPool = pool;
+    return true;
+}
+
+void Snapshot::close() {
+    file.close();
+    header = nullptr;
+    records = nullptr;
+    stringPool = nullptr;
+}
+
+size_t Snapshot::size() const {
+    return header != nullptr ? static_cast<size_t>(header->recordCount) : 0;
+}
+
+int Snapshot::getId(size_t index) const {
+    return records[index].id;
+}
+
+string_view Snapshot::getName(size_t index) const {
+    return string_view(stringPool + records[index].nameOffset, records[index].nameLength);
+}
+
+string_view Snapshot::getDept(size_t index) const {
+    return string_view(stringPool + records[index].deptOffset, records[index].deptLength);
+}
+
+double Snapshot::getGpa(size_t index) const {
+    return records[index].gpa;
+}
+
+RBTree::Student Snapshot::getStudent(size_t index) const {
+    return RBTree::Student(getId(index), string(getName(index)), string(getDept(index)), getGpa(index));
+}
+
+long long Snapshot::find(int id) const {
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (records[mid].id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < size() && records[lo].id == id) {
+        return static_cast<long long>(lo);
+    }
+    return -1;
+}
+
+size_t Snapshot::loadInto(RBTree& tree, vector<int> *invalid) const {
+    file.adviseSequential();
+    return tree.bulkLoad(size(), [this](size_t i) {
+        return RBTree::StudentView(getId(i), getName(i), getDept(i), getGpa(i));
+    }, nullptr, invalid);
+}
@@ -0,0 +1,79 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "MappedFile.h"
+#include "RBTree.h"
+
+// On-disk layout, version 1 (all integers little-endian):
+//
+//   SnapshotHeader    64 bytes
+//   SnapshotRecord[]  recordCount fixed-width records, sorted by ID
+//   string pool       interned names and departments, not terminated
+//
+// Each section has its own CRC-32 and the header checksums itself, so a
+// torn or truncated file is rejected when it is opened.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t recordCount;
+    uint64_t recordOffset;
+    uint64_t stringPoolOffset;
+    uint64_t stringPoolSize;
+    uint32_t recordChecksum;
+    uint32_t stringPoolChecksum;
+    uint32_t headerChecksum;    // CRC-32 of every header byte before this field
+    uint32_t reserved;
+};
+
+struct SnapshotRecord {
+    int32_t id;
+    uint32_t nameOffset;
+    uint32_t deptOffset;
+    uint16_t nameLength;
+    uint16_t deptLength;
+    double gpa;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+static_assert(sizeof(SnapshotRecord) == 24, "snapshot record must stay 24 bytes");
+
+// A snapshot opened through mmap. Lookups work straight off the mapping;
+// loadInto() rebuilds an RBTree with bulkLoad() since records are sorted.
+class Snapshot {
+private:
+    MappedFile file;
+    const SnapshotHeader *header;
+    const SnapshotRecord *records;
+    const char *stringPool;
+
+public:
+    static const uint32_t VERSION = 1;
+
+    static bool save(const RBTree& tree, const std::string& path, std::string *error = nullptr);
+
+    Snapshot();
+
+    bool open(const std::string& path, bool verifyChecksums = true, std::string *error = nullptr);
+    void close();
+
+    std::size_t size() const;
+    int getId(std::size_t index) const;
+    std::string_view getName(std::size_t index) const;
+    std::string_view getDept(std::size_t index) const;
+    double getGpa(std::size_t index) const;
+    RBTree::Student getStudent(std::size_t index) const;
+
+    // Binary search over the record section; returns -1 when absent.
+    long long find(int id) const;
+
+    // Replaces tree's contents; records with an invalid GPA are skipped
+    // and their IDs appended to invalid.
+    std::size_t loadInto(RBTree& tree, std::vector<int> *invalid = nullptr) const;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "StudentStorage.h"
+#include "BPlusTree.h"
+
+using namespace std;
+
+namespace {
+
+class RBTreeStorage : public StudentStorage {
+private:
+    RBTree tree;
+
+public:
+    bool insert(RBTree::Student&& student) override {
+        return tree.insert(student);
+    }
+    bool deleteNode(int id) override {
+        return tree.deleteNode(id);
+    }
+    optional<RBTree::StudentView> find(int id) const override {
+        RBTree::const_iterator it = tree.find(id);
+        if (it == tree.end()) {
+            return nullopt;
+        }
+        return *it;
+    }
+    void forEachInRange(int minID, int maxID,
+                        const function<void(const RBTree::StudentView&)>& visit) const override {
+        for (RBTree::StudentView student : tree.range(minID, maxID)) {
+            visit(student);
+        }
+    }
+    size_t bulkLoad(vector<RBTree::Student> students, vector<int> *duplicates,
+                    vector<int> *invalid) override {
+        return tree.bulkLoad(std::move(students), duplicates, invalid);
+    }
+    void clear() override {
+        tree.clear();
+    }
+    size_t size() const override {
+        return tree.size();
+    }
+    bool validate() const override {
+        return tree.validate();
+    }
+    const char *getEngineName() const override {
+        return "rbtree";
+    }
+};
+
+class BPlusTreeStorage : public StudentStorage {
+private:
+    BPlusTree tree;
+
+public:
+    bool insert(RBTree::Student&& student) override {
+        return tree.insert(std::move(student));
+    }
+    bool deleteNode(int id) override {
+        return tree.deleteNode(id);
+    }
+    optional<RBTree::StudentView> find(int id) const override {
+        const RBTree::Student *student = tree.find(id);
+        if (student == nullptr) {
+            return nullopt;
+        }
+        return RBTree::StudentView(*student);
+    }
+    void forEachInRange(int minID, int maxID,
+                        const function<void(const RBTree::StudentView&)>& visit) const override {
+        tree.forEachInRange(minID, maxID, [&visit](const RBTree::Student& student) {
+            visit(RBTree::StudentView(student));
+        });
+    }
+    size_t bulkLoad(vector<RBTree::Student> students, vector<int> *duplicates,
+                    vector<int> *invalid) override {
+        return tree.bulkLoad(std::move(students), duplicates, invalid);
+    }
+    void clear() override {
+        tree.clear();
+    }
+    size_t size() const override {
+        return tree.size();
+    }
+    bool validate() const override {
+        return tree.validate();
+    }
+    const char *getEngineName() const override {
+        return "bptree";
+    }
+};
+
+}
+
+StudentStorage::~StudentStorage() {}
+
+unique_ptr<StudentStorage> StudentStorage::create(StorageEngine engine) {
+    if (engine == BPLUS_TREE_ENGINE) {
+        return make_unique<BPlusTreeStorage>();
+    }
+    return make_unique<RBTreeStorage>();
+}
+
+bool StudentStorage::parseEngine(string_view name, StorageEngine& engine) {
+    if (name == "rbtree") {
+        engine = RBTREE_ENGINE;
+    } else if (name == "bptree") {
+        engine = BPLUS_TREE_ENGINE;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef STUDENTSTORAGE_H
+#define STUDENTSTORAGE_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "RBTree.h"
+
+enum StorageEngine { RBTREE_ENGINE, BPLUS_TREE_ENGINE };
+
+// The operations both storage engines share, so a caller (or a benchmark)
+// can pick the engine at construction time and run the same code on it.
+// The secondary indexes and order statistics stay RBTree-only.
+class StudentStorage {
+public:
+    virtual ~StudentStorage();
+
+    virtual bool insert(RBTree::Student&& student) = 0;
+    virtual bool deleteNode(int id) = 0;
+    // Empty when id is not stored. The view is valid until the next change.
+    virtual std::optional<RBTree::StudentView> find(int id) const = 0;
+    virtual void forEachInRange(int minID, int maxID,
+                                const std::function<void(const RBTree::StudentView&)>& visit) const = 0;
+    virtual std::size_t bulkLoad(std::vector<RBTree::Student> students,
+                                 std::vector<int> *duplicates = nullptr,
+                                 std::vector<int> *invalid = nullptr) = 0;
+    virtual void clear() = 0;
+    virtual std::size_t size() const = 0;
+    virtual bool validate() const = 0;
+    virtual const char *getEngineName() const = 0;
+
+    static std::unique_ptr<StudentStorage> create(StorageEngine engine);
+    // Accepts "rbtree" and "bptree".
+    static bool parseEngine(std::string_view name, StorageEngine& engine);
+};
+
+#endif
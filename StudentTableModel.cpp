@@ -0,0 +1,201 @@
+#include "StudentTableModel.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Rows within this distance of the cursor are reached by stepping the
+// iterator; anything further away costs one select().
+static const int CURSOR_STEP_LIMIT = 64;
+
+static QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+StudentTableModel::StudentTableModel(const ConcurrentRBTree *t, QObject *parent)
+    : QAbstractTableModel(parent), tree(t), mode(ALL_STUDENTS), rows(0), shownVersion(0),
+      cursorRow(-1), cursorVersion(0) {}
+
+int StudentTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : rows;
+}
+
+int StudentTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant StudentTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rows) {
+        return QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole) {
+        bool number = index.column() == ID_COLUMN || index.column() == GPA_COLUMN;
+        return number ? QVariant(int(Qt::AlignRight | Qt::AlignVCenter)) : QVariant();
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    return tree->read([&](const RBTree& t) -> QVariant {
+        RBTree::const_iterator it = studentAt(t, index.row());
+        if (it == t.end()) {
+            return QVariant();   // a removal the model has not seen yet
+        }
+        RBTree::StudentView student = *it;
+        switch (index.column()) {
+        case ID_COLUMN:
+            return student.getId();
+        case NAME_COLUMN:
+            return toQString(student.getName());
+        case DEPT_COLUMN:
+            return toQString(student.getDept());
+        case GPA_COLUMN:
+            return QString::number(student.getGpa(), 'f', 2);
+        default:
+            return QVariant();
+        }
+    });
+}
+
+QVariant StudentTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case ID_COLUMN:
+            return QString("ID");
+        case NAME_COLUMN:
+            return QString("Name");
+        case DEPT_COLUMN:
+            return QString("Department");
+        case GPA_COLUMN:
+            return QString("GPA");
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void StudentTableModel::setFilter(const std::string& name, const std::string& dept) {
+    nameFilter = name;
+    deptFilter = dept;
+    reload();
+}
+
+void StudentTableModel::reload() {
+    beginResetModel();
+    if (!nameFilter.empty()) {
+        mode = NAME_SEARCH;
+    } else if (!deptFilter.empty()) {
+        mode = DEPARTMENT;
+    } else {
+        mode = ALL_STUDENTS;
+    }
+    tree->read([this](const RBTree& t) {
+        shownVersion = tree->version();
+        collectIds(t);
+        rows = static_cast<int>(mode == ALL_STUDENTS ? t.size() : ids.size());
+    });
+    cursorRow = -1;
+    endResetModel();
+}
+
+void StudentTableModel::collectIds(const RBTree& t) {
+    ids.clear();
+    if (mode == DEPARTMENT) {
+        const std::set<int>& roster = t.getDepartmentIndex().studentsIn(deptFilter);
+        ids.assign(roster.begin(), roster.end());
+    } else if (mode == NAME_SEARCH) {
+        uint16_t deptCode = t.getDepartmentIndex().findCode(deptFilter);
+        for (const RBTree::StudentView& student : t.searchNameContaining(nameFilter, NAME_SEARCH_LIMIT)) {
+            if (deptFilter.empty() || student.getDeptCode() == deptCode) {
+                ids.push_back(student.getId());
+            }
+        }
+    }
+}
+
+void StudentTableModel::applyChanges(const QList<TreeChange>& changes) {
+    int newer = 0;
+    bool reloaded = false;
+    for (const TreeChange& change : changes) {
+        if (change.version > shownVersion) {
+            newer++;
+            reloaded = reloaded || change.kind == TreeChange::RELOADED;
+        }
+    }
+    if (newer == 0) {
+        return;
+    }
+
+    // Name matches are capped, so a change can pull in a row from past the
+    // cap; searching again is cheap
+    if (reloaded || mode == NAME_SEARCH || newer > CHANGE_BATCH_LIMIT) {
+        reload();
+        return;
+    }
+    for (const TreeChange& change : changes) {
+        if (change.version > shownVersion) {
+            applyChange(change);
+        }
+    }
+}
+
+void StudentTableModel::applyChange(const TreeChange& change) {
+    shownVersion = change.version;
+    cursorRow = -1;
+    bool inserted = change.kind == TreeChange::INSERTED;
+
+    if (mode == ALL_STUDENTS) {
+        if (inserted) {
+            beginInsertRows(QModelIndex(), change.row, change.row);
+            rows++;
+            endInsertRows();
+        } else {
+            beginRemoveRows(QModelIndex(), change.row, change.row);
+            rows--;
+            endRemoveRows();
+        }
+        return;
+    }
+
+    if (change.dept != deptFilter) {
+        return;
+    }
+    auto pos = std::lower_bound(ids.begin(), ids.end(), change.id);
+    int row = static_cast<int>(pos - ids.begin());
+    if (inserted) {
+        beginInsertRows(QModelIndex(), row, row);
+        ids.insert(pos, change.id);
+        rows++;
+        endInsertRows();
+    } else if (pos != ids.end() && *pos == change.id) {
+        beginRemoveRows(QModelIndex(), row, row);
+        ids.erase(pos);
+        rows--;
+        endRemoveRows();
+    }
+}
+
+// Called with the read lock held, which keeps version() still.
+RBTree::const_iterator StudentTableModel::studentAt(const RBTree& t, int row) const {
+    if (mode != ALL_STUDENTS) {
+        return t.find(ids[static_cast<std::size_t>(row)]);
+    }
+
+    if (cursorVersion != tree->version()) {
+        cursorRow = -1;     // the cursor may point at a freed node
+    }
+    if (cursorRow >= 0 && std::abs(row - cursorRow) <= CURSOR_STEP_LIMIT) {
+        for (; cursorRow < row && cursor != t.end(); cursorRow++) {
+            ++cursor;
+        }
+        for (; cursorRow > row; cursorRow--) {
+            --cursor;
+        }
+    } else {
+        cursor = t.select(static_cast<std::size_t>(row));
+        cursorRow = row;
+        cursorVersion = tree->version();
+    }
+    if (cursor == t.end()) {
+        cursorRow = -1;     // past the students the tree has right now
+    }
+    return cursor;
+}
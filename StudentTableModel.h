@@ -0,0 +1,71 @@
+#ifndef STUDENTTABLEMODEL_H
+#define STUDENTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ConcurrentRBTree.h"
+#include "TreeWorker.h"
+
+// Table model reading rows straight from the tree, so a view only
+// materializes the rows it paints. Unfiltered, row r is select(r); a small
+// cursor cache turns the sequential reads of a repaint into iterator steps.
+// With a department or name filter the model keeps just the matching IDs.
+//
+// The tree is written by a TreeWorker on another thread. The model's rows
+// only move when applyChanges() replays the worker's changes, in order, on
+// the UI thread; until then a cell may briefly show a neighbouring student
+// or stay blank. Every read takes the tree's read lock, and the cursor is
+// dropped whenever the tree's version() has moved on.
+class StudentTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { ID_COLUMN, NAME_COLUMN, DEPT_COLUMN, GPA_COLUMN, COLUMN_COUNT };
+
+    // Rows shown for a name search; the filter runs again on every keystroke.
+    static const std::size_t NAME_SEARCH_LIMIT = 500;
+    // Larger batches of changes reset the model instead of moving rows one
+    // at a time.
+    static const int CHANGE_BATCH_LIMIT = 256;
+
+    explicit StudentTableModel(const ConcurrentRBTree *tree, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    // Empty strings mean no filter. A name filter lists up to
+    // NAME_SEARCH_LIMIT matches, optionally within the department.
+    void setFilter(const std::string& name, const std::string& dept);
+    void reload();
+
+    // Moves rows for changes newer than the last reload, announcing each
+    // one (beginInsertRows/beginRemoveRows) so the view keeps its place.
+    void applyChanges(const QList<TreeChange>& changes);
+
+private:
+    enum Mode { ALL_STUDENTS, DEPARTMENT, NAME_SEARCH };
+
+    const ConcurrentRBTree *tree;
+    Mode mode;
+    std::string nameFilter;
+    std::string deptFilter;
+    int rows;
+    std::vector<int> ids;                       // matching IDs, ascending, unless ALL_STUDENTS
+    uint64_t shownVersion;                      // tree version the rows reflect
+
+    mutable RBTree::const_iterator cursor;
+    mutable int cursorRow;                      // -1 when the cursor is not set
+    mutable uint64_t cursorVersion;
+
+    void collectIds(const RBTree& t);
+    void applyChange(const TreeChange& change);
+    RBTree::const_iterator studentAt(const RBTree& t, int row) const;
+};
+
+#endif
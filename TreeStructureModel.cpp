@@ -0,0 +1,186 @@
+#include "TreeStructureModel.h"
+#include <QColor>
+
+static QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+TreeStructureModel::TreeStructureModel(const ConcurrentRBTree *t, QObject *parent)
+    : QAbstractItemModel(parent), tree(t), version(0), staleReported(false) {
+    reload();
+}
+
+QModelIndex TreeStructureModel::index(int row, int column, const QModelIndex& parent) const {
+    if (row < 0 || column < 0 || column >= COLUMN_COUNT || parent.column() > 0) {
+        return QModelIndex();
+    }
+    if (!parent.isValid()) {
+        return row == 0 && !items.isEmpty() ? createIndex(row, column, quintptr(0)) : QModelIndex();
+    }
+    const Item *up = itemOf(parent);
+    if (up == nullptr || row >= up->children.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, static_cast<quintptr>(up->children[row]));
+}
+
+QModelIndex TreeStructureModel::parent(const QModelIndex& child) const {
+    const Item *item = itemOf(child);
+    if (item == nullptr || item->parent < 0) {
+        return QModelIndex();
+    }
+    return createIndex(items[item->parent].row, 0, static_cast<quintptr>(item->parent));
+}
+
+int TreeStructureModel::rowCount(const QModelIndex& parent) const {
+    if (parent.column() > 0) {
+        return 0;
+    }
+    if (!parent.isValid()) {
+        return items.isEmpty() ? 0 : 1;
+    }
+    const Item *item = itemOf(parent);
+    return item != nullptr ? static_cast<int>(item->children.size()) : 0;
+}
+
+int TreeStructureModel::columnCount(const QModelIndex&) const {
+    return COLUMN_COUNT;
+}
+
+// Unfetched nodes still report children, so the view draws an expander.
+bool TreeStructureModel::hasChildren(const QModelIndex& parent) const {
+    if (parent.column() > 0) {
+        return false;
+    }
+    if (!parent.isValid()) {
+        return !items.isEmpty();
+    }
+    const Item *item = itemOf(parent);
+    return item != nullptr && item->childCount > 0;
+}
+
+bool TreeStructureModel::canFetchMore(const QModelIndex& parent) const {
+    const Item *item = itemOf(parent);
+    return item != nullptr && !item->fetched && item->childCount > 0;
+}
+
+void TreeStructureModel::fetchMore(const QModelIndex& parent) {
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    int position = static_cast<int>(parent.internalId());
+    int id = items[position].id;
+
+    // Copied under the read lock; nothing is taken if the tree has moved
+    // on, because the node may no longer sit where this model shows it.
+    QVector<Item> children;
+    bool current = tree->read([&](const RBTree& t) {
+        RBTree::const_iterator it = t.find(id);
+        if (tree->version() != version || it == t.end()) {
+            return false;
+        }
+        const RBTree::Node *node = it.getNode();
+        for (const RBTree::Node *child : {node->getLeft(), node->getRight()}) {
+            if (!t.isNil(child)) {
+                children.append(copyOf(t, child, position, static_cast<int>(children.size())));
+            }
+        }
+        return true;
+    });
+    if (!current) {
+        if (!staleReported) {
+            staleReported = true;
+            emit stale();
+        }
+        return;
+    }
+
+    items[position].fetched = true;
+    if (children.isEmpty()) {
+        return;
+    }
+    beginInsertRows(parent, 0, static_cast<int>(children.size()) - 1);
+    for (Item& child : children) {
+        items[position].children.append(static_cast<int>(items.size()));
+        items.append(std::move(child));
+    }
+    endInsertRows();
+}
+
+QVariant TreeStructureModel::data(const QModelIndex& index, int role) const {
+    const Item *item = itemOf(index);
+    if (item == nullptr) {
+        return QVariant();
+    }
+    if (role == Qt::ForegroundRole) {
+        return item->red && index.column() == NODE_COLUMN ? QVariant(QColor(Qt::red)) : QVariant();
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case NODE_COLUMN:
+        return QString("[%1] %2").arg(item->red ? "R" : "B").arg(item->id);
+    case NAME_COLUMN:
+        return item->name;
+    case SUBTREE_COLUMN:
+        return static_cast<qulonglong>(item->subtreeSize);
+    default:
+        return QVariant();
+    }
+}
+
+QVariant TreeStructureModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case NODE_COLUMN:
+            return QString("Node");
+        case NAME_COLUMN:
+            return QString("Name");
+        case SUBTREE_COLUMN:
+            return QString("Subtree");
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+int TreeStructureModel::idOf(const QModelIndex& index) const {
+    const Item *item = itemOf(index);
+    return item != nullptr ? item->id : 0;
+}
+
+void TreeStructureModel::reload() {
+    beginResetModel();
+    items.clear();
+    tree->read([this](const RBTree& t) {
+        version = tree->version();
+        if (t.size() > 0) {
+            items.append(copyOf(t, t.getRoot(), -1, 0));
+        }
+    });
+    staleReported = false;
+    endResetModel();
+}
+
+TreeStructureModel::Item TreeStructureModel::copyOf(const RBTree& t, const RBTree::Node *node,
+                                                    int parent, int row) const {
+    Item item;
+    item.id = node->getId();
+    item.red = node->getColor() == RED;
+    item.name = toQString(t.getStudent(node).getName());
+    item.subtreeSize = node->getSize();
+    item.parent = parent;
+    item.row = row;
+    // Empty children are detected with isNil(), not by ID, so ID 0 is fine.
+    item.childCount = int(!t.isNil(node->getLeft())) + int(!t.isNil(node->getRight()));
+    item.fetched = false;
+    return item;
+}
+
+const TreeStructureModel::Item *TreeStructureModel::itemOf(const QModelIndex& index) const {
+    if (!index.isValid() || index.model() != this || index.internalId() >= quintptr(items.size())) {
+        return nullptr;
+    }
+    return &items[static_cast<qsizetype>(index.internalId())];
+}
@@ -0,0 +1,72 @@
+#ifndef TREESTRUCTUREMODEL_H
+#define TREESTRUCTUREMODEL_H
+
+#include <QAbstractItemModel>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include "ConcurrentRBTree.h"
+
+// Item model over the red-black tree for a QTreeView: every node is an
+// item whose children are its left and right children. Nothing is built up
+// front; a node's children are copied in (fetchMore) when the view expands
+// it, so the cost follows what the user opens, whatever the size of the
+// tree.
+//
+// The model shows the tree as it was at the last reload(): nodes are copied
+// out under the read lock and never read again, so the structure changes
+// only through reload() and fetchMore()'s row insertions. fetchMore() adds
+// children only while the tree is still at the version reload() saw;
+// otherwise it emits stale() and adds nothing until the next reload().
+class TreeStructureModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Column { NODE_COLUMN, NAME_COLUMN, SUBTREE_COLUMN, COLUMN_COUNT };
+
+    explicit TreeStructureModel(const ConcurrentRBTree *tree, QObject *parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    // Student ID of the node behind an index.
+    int idOf(const QModelIndex& index) const;
+    // Takes a new copy of the root; children are fetched again on expansion.
+    void reload();
+
+signals:
+    // The tree changed since reload(), so an expansion could not be filled.
+    void stale();
+
+private:
+    // A node as it was when copied. Index ids are positions in items.
+    struct Item {
+        int id;
+        bool red;
+        QString name;
+        quint64 subtreeSize;
+        int parent;             // -1 for the root
+        int row;
+        int childCount;         // non-NIL children in the tree
+        bool fetched;
+        QVector<int> children;  // filled by fetchMore(), left first
+    };
+
+    const ConcurrentRBTree *tree;
+    QVector<Item> items;
+    uint64_t version;
+    bool staleReported;
+
+    Item copyOf(const RBTree& t, const RBTree::Node *node, int parent, int row) const;
+    const Item *itemOf(const QModelIndex& index) const;
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "TreeWorker.h"
+#include "CsvImporter.h"
+#include "Snapshot.h"
+#include <utility>
+#include <vector>
+
+// Rows between progress reports during long scans.
+static const qint64 PROGRESS_STEP = 65536;
+
+static QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+TreeWorker::TreeWorker(ConcurrentRBTree *t, QObject *parent) : QObject(parent), tree(t) {
+    // treeChanged crosses threads, so its argument must be a known type
+    qRegisterMetaType<QList<TreeChange>>();
+}
+
+void TreeWorker::addStudent(int id, const QString& name, const QString& dept, double gpa) {
+    // insert() returns false for an invalid GPA as well as a duplicate ID;
+    // rule the GPA out first so that false below means a duplicate.
+    if (!RBTree::isValidGpa(gpa)) {
+        emit studentAdded(id, name, QString("GPA must be a number between 0.00 and 4.00."));
+        return;
+    }
+
+    TreeChange change{TreeChange::INSERTED, id, 0, dept.toStdString(), 0};
+    bool added = tree->write([&](RBTree& t) {
+        if (!t.insert(id, name.toStdString(), change.dept, gpa)) {
+            return false;
+        }
+        change.row = static_cast<int>(t.rank(id));
+        change.version = tree->version();
+        if (t.countInDepartment(change.dept) == 1) {
+            emitDepartments(t);     // first student of a new department
+        }
+        return true;
+    });
+
+    if (added) {
+        emit treeChanged({change});
+    }
+    emit studentAdded(id, name, added ? QString()
+                                      : QString("A student with ID %1 already exists.").arg(id));
+}
+
+void TreeWorker::deleteStudent(int id) {
+    TreeChange change{TreeChange::REMOVED, id, 0, std::string(), 0};
+    bool deleted = tree->write([&](RBTree& t) {
+        RBTree::const_iterator it = t.find(id);
+        if (it == t.end()) {
+            return false;
+        }
+        change.dept = std::string(it->getDept());
+        change.row = static_cast<int>(t.rank(id));
+        t.deleteNode(id);
+        change.version = tree->version();
+        if (t.countInDepartment(change.dept) == 0) {
+            emitDepartments(t);     // last student of the department
+        }
+        return true;
+    });
+
+    if (deleted) {
+        emit treeChanged({change});
+    }
+    emit studentDeleted(id, deleted);
+}
+
+void TreeWorker::queryRange(int minId, int maxId) {
+    QStringList lines;
+    tree->read([&](const RBTree& t) {
+        qint64 total = static_cast<qint64>(t.countRange(minId, maxId));
+        lines.reserve(total);
+        for (RBTree::StudentView student : t.range(minId, maxId)) {
+            lines.append(QString("ID: %1 | Name: %2 | Dept: %3 | GPA: %4")
+                             .arg(student.getId())
+                             .arg(toQString(student.getName()))
+                             .arg(toQString(student.getDept()))
+                             .arg(student.getGpa(), 0, 'f', 2));
+            if (lines.size() % PROGRESS_STEP == 0) {
+                emit progress("Collecting range", lines.size(), total);
+            }
+        }
+    });
+    emit rangeReady(minId, maxId, lines);
+}
+
+void TreeWorker::loadSnapshot(const QString& path) {
+    emit progress("Opening snapshot", 0, 0);
+    Snapshot snapshot;
+    std::string error;
+    if (!snapshot.open(path.toStdString(), true, &error)) {
+        emit operationFinished("Open Failed", QString::fromStdString(error), false);
+        return;
+    }
+
+    emit progress("Building tree", 0, 0);
+    RBTree staging;
+    std::vector<int> invalid;
+    size_t loaded = snapshot.loadInto(staging, &invalid);
+    replaceTree(staging);
+    QString message = QString("Loaded %1 students from %2").arg(loaded).arg(path);
+    if (!invalid.empty()) {
+        message += QString("\nSkipped %1 students with an invalid GPA").arg(invalid.size());
+    }
+    emit operationFinished("Snapshot Loaded", message, true);
+}
+
+void TreeWorker::saveSnapshot(const QString& path) {
+    emit progress("Saving snapshot", 0, 0);
+    std::string error;
+    size_t saved = 0;
+    bool ok = tree->read([&](const RBTree& t) {
+        saved = t.size();
+        return Snapshot::save(t, path.toStdString(), &error);
+    });
+
+    if (!ok) {
+        emit operationFinished("Save Failed", QString::fromStdString(error), false);
+        return;
+    }
+    emit operationFinished("Snapshot Saved",
+        QString("Saved %1 students to %2").arg(saved).arg(path), true);
+}
+
+// The import runs against a copy of the current students, so duplicates
+// are still caught and the live tree only changes when the copy is swapped
+// in. Needs memory for both trees while it runs.
+void TreeWorker::importCsv(const QString& path) {
+    std::vector<RBTree::Student> current;
+    tree->read([&](const RBTree& t) {
+        qint64 total = static_cast<qint64>(t.size());
+        current.reserve(t.size());
+        for (RBTree::StudentView student : t) {
+            current.push_back(student.toStudent());
+            if (static_cast<qint64>(current.size()) % PROGRESS_STEP == 0) {
+                emit progress("Copying current students", static_cast<qint64>(current.size()), total);
+            }
+        }
+    });
+    RBTree staging;
+    staging.bulkLoad(std::move(current));
+
+    emit progress("Importing " + path, 0, 0);
+    ImportReport report;
+    std::string error;
+    if (!CsvImporter().importFile(path.toStdString(), staging, report, &error)) {
+        emit operationFinished("Import Failed", QString::fromStdString(error), false);
+        return;
+    }
+    replaceTree(staging);
+
+    QString message = QString("Rows read: %1\nImported: %2\nRejected: %3\nDuplicates: %4\nTime: %5 s")
+                          .arg(report.rowsRead)
+                          .arg(report.imported)
+                          .arg(report.rejected)
+                          .arg(report.duplicates)
+                          .arg(report.seconds, 0, 'f', 2);
+    for (const std::string& reason : report.errors) {
+        message += "\n" + QString::fromStdString(reason);
+    }
+    emit operationFinished("CSV Import", message, true);
+}
+
+// Makes staging the live tree. The write lock is held only for the O(1)
+// swap; the old students end up in staging and are freed by the caller.
+void TreeWorker::replaceTree(RBTree& staging) {
+    uint64_t version = tree->write([&](RBTree& t) {
+        t.swap(staging);
+        emitDepartments(t);
+        return tree->version();
+    });
+    emit treeChanged({TreeChange{TreeChange::RELOADED, 0, 0, std::string(), version}});
+}
+
+void TreeWorker::emitDepartments(const RBTree& t) {
+    QStringList departments;
+    for (std::string_view dept : t.getDepartmentIndex().departments()) {
+        departments.append(toQString(dept));
+    }
+    emit departmentsChanged(departments);
+}
@@ -0,0 +1,72 @@
+#ifndef TREEWORKER_H
+#define TREEWORKER_H
+
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <string>
+#include "ConcurrentRBTree.h"
+
+// One change to the tree as seen by a table: the row is the position in ID
+// order (the new row of an insert, the old row of a removal) and version is
+// the tree's version() for that write, so a model that reloaded after it
+// can skip it. RELOADED means the whole tree was replaced.
+struct TreeChange {
+    enum Kind { INSERTED, REMOVED, RELOADED };
+
+    Kind kind;
+    int id;
+    int row;
+    std::string dept;
+    uint64_t version;
+};
+
+Q_DECLARE_METATYPE(TreeChange)
+
+// Runs the GUI's tree work on its own thread (moveToThread). Every write to
+// the tree goes through here, one request at a time, so requests queued
+// behind a long import simply wait their turn while the window stays live.
+// Writes hold the tree's write lock only briefly: loads and imports build a
+// separate tree first and swap it in. Readers on the UI thread use the
+// tree's read lock.
+//
+// Call the slots through queued connections or QMetaObject::invokeMethod;
+// results come back as signals.
+class TreeWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TreeWorker(ConcurrentRBTree *tree, QObject *parent = nullptr);
+
+public slots:
+    void addStudent(int id, const QString& name, const QString& dept, double gpa);
+    void deleteStudent(int id);
+    void queryRange(int minId, int maxId);
+    void loadSnapshot(const QString& path);
+    void saveSnapshot(const QString& path);
+    void importCsv(const QString& path);
+
+signals:
+    // error is empty when the student was added, else why not.
+    void studentAdded(int id, const QString& name, const QString& error);
+    void studentDeleted(int id, bool deleted);
+    void treeChanged(const QList<TreeChange>& changes);
+    void departmentsChanged(const QStringList& departments);
+    void rangeReady(int minId, int maxId, const QStringList& lines);
+
+    // Long operations report progress as they go (total 0 when unknown)
+    // and finish with one summary, ok or not.
+    void progress(const QString& stage, qint64 done, qint64 total);
+    void operationFinished(const QString& title, const QString& message, bool ok);
+
+private:
+    ConcurrentRBTree *tree;
+
+    void replaceTree(RBTree& staging);
+    void emitDepartments(const RBTree& t);
+};
+
+#endif
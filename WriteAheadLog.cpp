@@ -0,0 +1,364 @@
+#include "WriteAheadLog.h"
+#include "Checksum.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const char WAL_MAGIC[8] = {'S', 'T', 'U', 'D', 'W', 'A', 'L', '1'};
+const size_t RECORD_HEADER_SIZE = 8;
+// Buffered bytes are written (not fsynced) once they reach this size.
+const size_t WRITE_CHUNK = 1 << 20;
+
+bool fail(string *error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+    return false;
+}
+
+#ifdef _WIN32
+int openLog(const string& path) {
+    return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+long long writeLog(int fd, const char *data, size_t length) {
+    return _write(fd, data, static_cast<unsigned int>(length));
+}
+bool syncLog(int fd) { return _commit(fd) == 0; }
+bool truncateLog(int fd, uint64_t length) { return _chsize_s(fd, static_cast<long long>(length)) == 0; }
+void closeLog(int fd) { _close(fd); }
+#else
+int openLog(const string& path) {
+    return ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+}
+long long writeLog(int fd, const char *data, size_t length) {
+    return ::write(fd, data, length);
+}
+bool syncLog(int fd) {
+#ifdef __linux__
+    return fdatasync(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+}
+bool truncateLog(int fd, uint64_t length) { return ftruncate(fd, static_cast<off_t>(length)) == 0; }
+void closeLog(int fd) { ::close(fd); }
+#endif
+
+bool writeAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        long long written = writeLog(fd, data, length);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+template <typename T>
+void put(vector<char>& out, T value) {
+    const char *bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T get(const unsigned char *bytes) {
+    T value;
+    memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Walks the intact records of a log image, calling apply(op, student) for
+// each, and returns the byte length of the valid prefix. Returns 0 if the
+// magic is wrong.
+template <typename Apply>
+uint64_t scanLog(const unsigned char *data, size_t size, Apply apply) {
+    if (size < sizeof(WAL_MAGIC) || memcmp(data, WAL_MAGIC, sizeof(WAL_MAGIC)) != 0) {
+        return 0;
+    }
+
+    size_t pos = sizeof(WAL_MAGIC);
+    while (size - pos >= RECORD_HEADER_SIZE) {
+        uint32_t length = get<uint32_t>(data + pos);
+        uint32_t checksum = get<uint32_t>(data + pos + 4);
+        if (length < 5 || length > size - pos - RECORD_HEADER_SIZE) {
+            break;
+        }
+        const unsigned char *payload = data + pos + RECORD_HEADER_SIZE;
+        if (crc32(payload, length) != checksum) {
+            break;
+        }
+
+        uint8_t op = payload[0];
+        int id = get<int32_t>(payload + 1);
+        if (op == WriteAheadLog::OP_INSERT) {
+            if (length < 21) {
+                break;
+            }
+            double gpa = get<double>(payload + 5);
+            uint32_t nameLength = get<uint32_t>(payload + 13);
+            uint32_t deptLength = get<uint32_t>(payload + 17);
+            if (uint64_t(21) + nameLength + deptLength != length) {
+                break;
+            }
+            const char *text = reinterpret_cast<const char*>(payload + 21);
+            apply(op, RBTree::Student(id, string(text, nameLength),
+                                      string(text + nameLength, deptLength), gpa));
+        } else if (op == WriteAheadLog::OP_DELETE) {
+            apply(op, RBTree::Student(id, string(), string(), 0.0));
+        } else if (op == WriteAheadLog::OP_UPDATE_GPA) {
+            if (length != 13) {
+                break;
+            }
+            apply(op, RBTree::Student(id, string(), string(), get<double>(payload + 5)));
+        } else {
+            break;
+        }
+        pos += RECORD_HEADER_SIZE + length;
+    }
+    return pos;
+}
+
+}
+
+WalOptions::WalOptions() : groupCommitSize(256), syncInterval(10) {}
+
+WriteAheadLog::WriteAheadLog() : fd(-1), pendingRecords(0), failed(false), stopping(false) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const string& path, const WalOptions& walOptions, string *error) {
+    close();
+    options = walOptions;
+    if (options.groupCommitSize == 0) {
+        options.groupCommitSize = 1;
+    }
+
+    // Find where the intact records end so a torn tail can be cut off.
+    uint64_t validLength = 0;
+    bool exists = filesystem::exists(path) && filesystem::file_size(path) > 0;
+    if (exists) {
+        MappedFile existing;
+        if (!existing.open(path)) {
+            return fail(error, "Cannot read log " + path + ".");
+        }
+        validLength = scanLog(existing.data(), existing.size(),
+                              [](uint8_t, RBTree::Student&&) {});
+        if (validLength == 0) {
+            return fail(error, path + " is not a student write-ahead log.");
+        }
+    }
+
+    fd = openLog(path);
+    if (fd < 0) {
+        return fail(error, "Cannot open log " + path + " for writing.");
+    }
+    if (!exists) {
+        if (!writeAll(fd, WAL_MAGIC, sizeof(WAL_MAGIC)) || !syncLog(fd)) {
+            close();
+            return fail(error, "Cannot initialize log " + path + ".");
+        }
+    } else if (validLength < filesystem::file_size(path)) {
+        if (!truncateLog(fd, validLength) || !syncLog(fd)) {
+            close();
+            return fail(error, "Cannot truncate torn tail of " + path + ".");
+        }
+    }
+
+    failed = false;
+    stopping = false;
+    if (options.syncInterval.count() > 0) {
+        flusher = thread(&WriteAheadLog::flusherLoop, this);
+    }
+    return true;
+}
+
+void WriteAheadLog::close() {
+    {
+        lock_guard<mutex> lock(logMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    if (fd >= 0) {
+        lock_guard<mutex> lock(logMutex);
+        syncLocked();
+        closeLog(fd);
+        fd = -1;
+    }
+    buffer.clear();
+    pendingRecords = 0;
+}
+
+bool WriteAheadLog::appendInsert(int id, string_view name, string_view dept, double gpa) {
+    vector<char> payload;
+    payload.reserve(21 + name.size() + dept.size());
+    put<uint8_t>(payload, OP_INSERT);
+    put<int32_t>(payload, id);
+    put<double>(payload, gpa);
+    put<uint32_t>(payload, static_cast<uint32_t>(name.size()));
+    put<uint32_t>(payload, static_cast<uint32_t>(dept.size()));
+    payload.insert(payload.end(), name.begin(), name.end());
+    payload.insert(payload.end(), dept.begin(), dept.end());
+    return append(payload);
+}
+
+bool WriteAheadLog::appendDelete(int id) {
+    vector<char> payload;
+    put<uint8_t>(payload, OP_DELETE);
+    put<int32_t>(payload, id);
+    return append(payload);
+}
+
+bool WriteAheadLog::appendUpdateGpa(int id, double gpa) {
+    vector<char> payload;
+    put<uint8_t>(payload, OP_UPDATE_GPA);
+    put<int32_t>(payload, id);
+    put<double>(payload, gpa);
+    return append(payload);
+}
+
+bool WriteAheadLog::append(const vector<char>& payload) {
+    lock_guard<mutex> lock(logMutex);
+    if (fd < 0 || failed) {
+        return false;
+    }
+
+    put<uint32_t>(buffer, static_cast<uint32_t>(payload.size()));
+    put<uint32_t>(buffer, crc32(payload.data(), payload.size()));
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
+
+    if (pendingRecords++ == 0) {
+        oldestPending = chrono::steady_clock::now();
+        wake.notify_one();
+    }
+    if (pendingRecords >= options.groupCommitSize) {
+        return syncLocked();
+    }
+    if (buffer.size() >= WRITE_CHUNK) {
+        return writeBuffered();
+    }
+    return true;
+}
+
+bool WriteAheadLog::writeBuffered() {
+    if (buffer.empty()) {
+        return true;
+    }
+    if (!writeAll(fd, buffer.data(), buffer.size())) {
+        failed = true;
+        return false;
+    }
+    buffer.clear();
+    return true;
+}
+
+bool WriteAheadLog::syncLocked() {
+    if (fd < 0 || failed) {
+        return false;
+    }
+    if (pendingRecords == 0 && buffer.empty()) {
+        return true;
+    }
+    if (!writeBuffered() || !syncLog(fd)) {
+        failed = true;
+        return false;
+    }
+    pendingRecords = 0;
+    return true;
+}
+
+bool WriteAheadLog::sync() {
+    lock_guard<mutex> lock(logMutex);
+    return syncLocked();
+}
+
+bool WriteAheadLog::reset() {
+    lock_guard<mutex> lock(logMutex);
+    if (fd < 0) {
+        return false;
+    }
+    buffer.clear();
+    pendingRecords = 0;
+    if (!truncateLog(fd, sizeof(WAL_MAGIC)) || !syncLog(fd)) {
+        failed = true;
+        return false;
+    }
+    failed = false;
+    return true;
+}
+
+// Background group commit: fsyncs whatever is pending once the oldest
+// record has waited syncInterval, so a quiet writer is never left with an
+// unsynced partial batch.
+void WriteAheadLog::flusherLoop() {
+    unique_lock<mutex> lock(logMutex);
+    while (!stopping) {
+        if (pendingRecords == 0) {
+            wake.wait(lock, [this] { return stopping || pendingRecords > 0; });
+            continue;
+        }
+        auto deadline = oldestPending + options.syncInterval;
+        if (chrono::steady_clock::now() >= deadline) {
+            syncLocked();
+            continue;
+        }
+        wake.wait_until(lock, deadline);
+    }
+}
+
+bool WriteAheadLog::replay(const string& path, RBTree& tree, size_t *applied, string *error) {
+    size_t count = 0;
+    if (applied != nullptr) {
+        *applied = 0;
+    }
+    if (!filesystem::exists(path) || filesystem::file_size(path) == 0) {
+        return true;
+    }
+
+    MappedFile log;
+    if (!log.open(path)) {
+        return fail(error, "Cannot read log " + path + ".");
+    }
+    log.adviseSequential();
+
+    // Only successful mutations are logged, so re-applying a record the
+    // snapshot already contains (crash between checkpoint and reset) is a
+    // harmless no-op.
+    uint64_t validLength = scanLog(log.data(), log.size(), [&](uint8_t op, RBTree::Student&& student) {
+        if (op == OP_INSERT) {
+            tree.insert(student);
+        } else if (op == OP_DELETE) {
+            tree.deleteNode(student.getId());
+        } else {
+            tree.updateGpa(student.getId(), student.getGpa());
+        }
+        count++;
+    });
+    if (validLength == 0) {
+        return fail(error, path + " is not a student write-ahead log.");
+    }
+
+    if (applied != nullptr) {
+        *applied = count;
+    }
+    return true;
+}
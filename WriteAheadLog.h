@@ -0,0 +1,79 @@
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "RBTree.h"
+
+struct WalOptions {
+    // fsync as soon as this many records are waiting...
+    std::size_t groupCommitSize;
+    // ...or once the oldest waiting record is this old (0 = only by size/sync()).
+    std::chrono::milliseconds syncInterval;
+
+    WalOptions();
+};
+
+// Append-only log of tree mutations.
+//
+// File layout: 8-byte magic, then records of
+//   [u32 payload length][u32 CRC-32 of payload][payload]
+// where the payload is an op byte, the student ID and, for inserts, the GPA
+// and the name/department bytes (GPA updates carry just the GPA). Appends are buffered and made durable in
+// groups; a torn record at the tail (crash mid-write) ends replay and is cut
+// off the next time the log is opened.
+class WriteAheadLog {
+public:
+    enum Op : uint8_t { OP_INSERT = 1, OP_DELETE = 2, OP_UPDATE_GPA = 3 };
+
+private:
+    int fd;
+    WalOptions options;
+    std::vector<char> buffer;
+    std::size_t pendingRecords;
+    std::chrono::steady_clock::time_point oldestPending;
+    bool failed;
+    bool stopping;
+    std::mutex logMutex;
+    std::condition_variable wake;
+    std::thread flusher;
+
+    bool append(const std::vector<char>& payload);
+    bool writeBuffered();
+    bool syncLocked();
+    void flusherLoop();
+
+public:
+    WriteAheadLog();
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Creates the log if needed and truncates any torn tail.
+    bool open(const std::string& path, const WalOptions& walOptions = WalOptions(),
+              std::string *error = nullptr);
+    void close();
+
+    bool appendInsert(int id, std::string_view name, std::string_view dept, double gpa);
+    bool appendDelete(int id);
+    bool appendUpdateGpa(int id, double gpa);
+
+    // Writes and fsyncs everything appended so far.
+    bool sync();
+    // Drops every record, e.g. after the tree was checkpointed to a snapshot.
+    bool reset();
+
+    // Applies every intact record of the log at path to tree. A missing
+    // file counts as an empty log.
+    static bool replay(const std::string& path, RBTree& tree, std::size_t *applied = nullptr,
+                       std::string *error = nullptr);
+};
+
+#endif
@@ -1,14 +1,152 @@
+#include <charconv>
+#include <climits>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <filesystem>
+#include "BatchRunner.h"
+#include "CsvImporter.h"
+#include "DurableStore.h"
+#include "Metrics.h"
 #include "RBTree.h"
+#include "Snapshot.h"
 
 using namespace std;
 
-int main() {
-    RBTree sis;
+static void printUsage(const char *program) {
+    cout << "Usage: " << program << " [--snapshot FILE | --data-dir DIR]\n";
+    cout << "  --snapshot FILE   load students from FILE at startup and save back to it\n";
+    cout << "  --data-dir DIR    keep students in DIR, logging every change as it happens\n";
+    cout << "  --import FILE     load a CSV/TSV file (id,name,dept,gpa), save to the\n";
+    cout << "                    snapshot or data directory if one is given, and exit\n";
+    cout << "  --threads N       parser threads for --import (default: all cores)\n";
+    cout << "  --batch FILE      run commands from FILE (- for stdin) without prompts and exit\n";
+}
+
+static void printImportReport(const ImportReport& report) {
+    cout << "Rows read:   " << report.rowsRead << "\n";
+    cout << "Imported:    " << report.imported << "\n";
+    cout << "Rejected:    " << report.rejected << "\n";
+    cout << "Duplicates:  " << report.duplicates << "\n";
+    cout << "Time:        " << report.seconds << " s ("
+         << static_cast<long long>(report.rowsPerSecond()) << " rows/sec)\n";
+    for (const string& message : report.errors) {
+        cout << "  rejected at " << message << "\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
     int choice, id, minID, maxID;
     string name, dept;
     double gpa;
+    string snapshotPath;
+    string dataDir;
+    string importPath;
+    unsigned importThreads = 0;
+    string batchPath;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--snapshot" && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--import" && i + 1 < argc) {
+            importPath = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            const char *text = argv[++i];
+            const char *end = text + strlen(text);
+            auto result = from_chars(text, end, importThreads);
+            if (result.ec != errc() || result.ptr != end || end == text) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (!snapshotPath.empty() && !dataDir.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    RBTree memoryTree;
+    DurableStore durable;
+    bool isDurable = !dataDir.empty();
+    RBTree& sis = isDurable ? durable.getTree() : memoryTree;
+    // Batch output on stdout is meant for other programs; keep startup
+    // notes out of it.
+    ostream& status = batchPath.empty() ? cout : cerr;
+
+    if (isDurable) {
+        string error;
+        if (!durable.open(dataDir, WalOptions(), &error)) {
+            status << "Error: " << error << "\n";
+            return 1;
+        }
+        status << "Opened " << dataDir << ": " << sis.size() << " students ("
+               << durable.getReplayedCount() << " changes replayed from the log)\n";
+        if (durable.getSkippedCount() > 0) {
+            status << "Skipped " << durable.getSkippedCount() << " students with an invalid GPA\n";
+        }
+    }
+
+    if (!snapshotPath.empty() && filesystem::exists(snapshotPath)) {
+        Snapshot snapshot;
+        string error;
+        if (!snapshot.open(snapshotPath, true, &error)) {
+            status << "Error: " << error << "\n";
+            return 1;
+        }
+        vector<int> invalid;
+        size_t loaded = snapshot.loadInto(sis, &invalid);
+        status << "Loaded " << loaded << " students from " << snapshotPath << "\n";
+        if (!invalid.empty()) {
+            status << "Skipped " << invalid.size() << " students with an invalid GPA\n";
+        }
+    }
+
+    if (!importPath.empty()) {
+        CsvImporter importer(importThreads);
+        ImportReport report;
+        string error;
+        if (!importer.importFile(importPath, sis, report, &error)) {
+            cout << "Error: " << error << "\n";
+            return 1;
+        }
+        printImportReport(report);
+
+        // The import bypasses the log, so persist it as a fresh checkpoint.
+        bool saved = true;
+        if (isDurable) {
+            saved = durable.checkpoint(&error);
+        } else if (!snapshotPath.empty()) {
+            saved = Snapshot::save(sis, snapshotPath, &error);
+        }
+        if (!saved) {
+            cout << "Error: " << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!batchPath.empty()) {
+        FILE *input = batchPath == "-" ? stdin : fopen(batchPath.c_str(), "rb");
+        if (input == nullptr) {
+            cerr << "Error: Cannot open " << batchPath << "\n";
+            return 1;
+        }
+        BufferedWriter output(stdout);
+        BatchRunner runner(sis, output, isDurable ? &durable : nullptr);
+        runner.run(input);
+        if (input != stdin) {
+            fclose(input);
+        }
+        return runner.getErrorCount() == 0 ? 0 : 2;
+    }
 
     cout << "========================================\n";
     cout << "  Student Information System (RB-Tree)\n";
@@ -22,7 +160,9 @@ int main() {
         cout << "4. Delete Student\n";
         cout << "5. Display All Students (Sorted)\n";
         cout << "6. Visualize Tree Structure\n";
-        cout << "7. Exit\n";
+        cout << "7. Save Snapshot\n";
+        cout << "8. Show Metrics\n";
+        cout << "9. Exit\n";
         cout << "Enter choice: ";
         cin >> choice;
 
@@ -38,8 +178,11 @@ int main() {
             getline(cin, dept);
             cout << "Enter GPA: ";
             cin >> gpa;
-            sis.insert(id, name, dept, gpa);
-            cout << "Student added successfully!\n";
+            if (isDurable ? durable.insert(id, name, dept, gpa) : sis.insert(id, name, dept, gpa)) {
+                cout << "Student added successfully!\n";
+            } else {
+                cout << "Error: Student with ID " << id << " already exists.\n";
+            }
             break;
 
         case 2:
@@ -62,8 +205,11 @@ int main() {
             cout << "\n--- Delete Student ---\n";
             cout << "Enter Student ID to delete: ";
             cin >> id;
-            sis.deleteNode(id);
-            cout << "Student deleted successfully (if found).\n";
+            if (isDurable ? durable.deleteNode(id) : sis.deleteNode(id)) {
+                cout << "Student deleted successfully.\n";
+            } else {
+                cout << "Student with ID " << id << " not found in the tree.\n";
+            }
             break;
 
         case 5:
@@ -71,13 +217,54 @@ int main() {
             sis.inorder();
             break;
 
-        case 6:
+        case 6: {
             cout << "\n--- Tree Structure Visualization ---\n";
+            cout << "Levels to show (0 = all): ";
+            int levels;
+            cin >> levels;
             cout << "(L = Left Child, R = Right Child)\n\n";
-            sis.printTree();
+            sis.printTree(levels > 0 ? levels - 1 : INT_MAX);
+            break;
+        }
+
+        case 7: {
+            cout << "\n--- Save Snapshot ---\n";
+            if (isDurable) {
+                string error;
+                if (durable.checkpoint(&error)) {
+                    cout << "Checkpointed " << sis.size() << " students into " << dataDir << "\n";
+                } else {
+                    cout << "Error: " << error << "\n";
+                }
+                break;
+            }
+            string path = snapshotPath;
+            if (path.empty()) {
+                cout << "Enter snapshot file path: ";
+                cin >> path;
+            }
+            string error;
+            if (Snapshot::save(sis, path, &error)) {
+                cout << "Saved " << sis.size() << " students to " << path << "\n";
+            } else {
+                cout << "Error: " << error << "\n";
+            }
             break;
+        }
+
+        case 8: {
+            cout << "\n--- Metrics ---\n";
+            cout << "Format (1 = text, 2 = JSON): ";
+            int format;
+            cin >> format;
+            cout << (format == 2 ? Metrics::formatJson(sis) + "\n" : Metrics::formatText(sis));
+            break;
+        }
 
-        case 7:
+        case 9:
+            if (isDurable) {
+                durable.sync();
+            }
             cout << "\nExiting Student Information System. Goodbye!\n";
             return 0;
 
@@ -0,0 +1,979 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "ColumnSnapshot.h"
+#include "ConcurrentRBTree.h"
+#include "CsvImporter.h"
+#include "RBTree.h"
+#include "Snapshot.h"
+#include "StudentStorage.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Every allocation in the process goes through these, so each benchmark can
+// report allocations per operation. NodePool allocates over-aligned chunks,
+// hence the align_val_t forms.
+static atomic<uint64_t> allocationCount(0);
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void *operator new(size_t size, align_val_t align) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    size_t alignment = static_cast<size_t>(align);
+    size_t rounded = max(alignment, (size + alignment - 1) / alignment * alignment);
+#ifdef _WIN32
+    void *p = _aligned_malloc(rounded, alignment);
+#else
+    void *p = aligned_alloc(alignment, rounded);
+#endif
+    if (p) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+// GCC takes the free() here for a mismatch with the operator new it pairs
+// with, not knowing both are replaced
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *p) noexcept {
+    free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete(void *p, size_t) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete(void *p, align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+void operator delete(void *p, size_t, align_val_t align) noexcept {
+    ::operator delete(p, align);
+}
+
+// Results feed this so the optimizer cannot drop the work being timed.
+static volatile size_t sink;
+
+// Linux lets a process reset its peak RSS, so each benchmark gets its own
+// figure (plus what the process holds between benchmarks); elsewhere it is
+// the peak of the whole run so far.
+static void resetPeakRss() {
+#ifdef __GLIBC__
+    malloc_trim(0);     // hand back what earlier benchmarks freed
+#endif
+#ifdef __linux__
+    ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+static size_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+struct BenchOptions {
+    vector<size_t> sizes;
+    uint64_t seed;
+    unsigned threads;
+    string filter;
+    bool csv;
+    bool list;
+};
+
+struct BenchResult {
+    size_t ops;
+    double seconds;
+    vector<uint32_t> latencies;     // ns per operation; empty when timed as one block
+    uint64_t allocations;
+    string note;
+
+    BenchResult() : ops(0), seconds(0), allocations(0) {}
+};
+
+struct Benchmark {
+    string name;
+    function<void(size_t n, uint64_t seed, BenchResult& result)> run;
+};
+
+// Calls op(i) for i in [0, ops), taking one clock reading per call; the
+// latencies are reserved up front so the loop itself does not allocate.
+template <typename Op>
+static double recordEach(vector<uint32_t>& latencies, size_t ops, Op op) {
+    latencies.reserve(latencies.size() + ops);
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+    for (size_t i = 0; i < ops; i++) {
+        op(i);
+        Clock::time_point now = Clock::now();
+        int64_t ns = chrono::duration_cast<chrono::nanoseconds>(now - last).count();
+        latencies.push_back(static_cast<uint32_t>(min<int64_t>(ns, UINT32_MAX)));
+        last = now;
+    }
+    return chrono::duration<double>(last - start).count();
+}
+
+template <typename Op>
+static void timeEach(BenchResult& result, size_t ops, Op op) {
+    result.latencies.reserve(result.latencies.size() + ops);
+    uint64_t allocations = allocationCount.load();
+    result.seconds += recordEach(result.latencies, ops, op);
+    result.allocations += allocationCount.load() - allocations;
+    result.ops += ops;
+}
+
+// Times fn() as a whole, counting it as ops operations: bulk work has no
+// meaningful per-operation latency.
+template <typename Fn>
+static void timeBlock(BenchResult& result, size_t ops, Fn fn) {
+    uint64_t allocations = allocationCount.load();
+    Clock::time_point start = Clock::now();
+    fn();
+    result.seconds += chrono::duration<double>(Clock::now() - start).count();
+    result.allocations += allocationCount.load() - allocations;
+    result.ops += ops;
+}
+
+// ---- Workloads -------------------------------------------------------------
+
+static const char *FIRST_NAMES[] = {
+    "James", "Mary", "John", "Patricia", "Robert", "Jennifer", "Michael", "Linda",
+    "William", "Elizabeth", "David", "Barbara", "Richard", "Susan", "Joseph", "Jessica",
+    "Thomas", "Sarah", "Charles", "Karen", "Wei", "Aisha", "Mateo", "Yuki",
+    "Olga", "Ravi", "Fatima", "Lars", "Chloe", "Kwame", "Ingrid", "Tomasz"
+};
+static const char *LAST_NAMES[] = {
+    "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis",
+    "Rodriguez", "Martinez", "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Taylor",
+    "Moore", "Jackson", "Martin", "Lee", "Perez", "Thompson", "White", "Harris",
+    "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson", "Nakamura", "Okafor", "Ivanova",
+    "Patel", "Kowalski", "Nguyen", "Schmidt", "Rossi", "Dubois", "Larsen", "Haddad"
+};
+static const char *DEPARTMENTS[] = {
+    "Computer Science", "Mathematics", "Physics", "Chemistry", "Biology", "History",
+    "Economics", "Philosophy", "English", "Music", "Civil Engineering", "Electrical Engineering"
+};
+
+static const size_t FIRST_NAME_COUNT = sizeof(FIRST_NAMES) / sizeof(FIRST_NAMES[0]);
+static const size_t LAST_NAME_COUNT = sizeof(LAST_NAMES) / sizeof(LAST_NAMES[0]);
+static const size_t DEPARTMENT_COUNT = sizeof(DEPARTMENTS) / sizeof(DEPARTMENTS[0]);
+
+// Students get the even IDs 0, 2, ..., 2(n-1), so odd IDs are known misses.
+static int idAt(size_t index) {
+    return static_cast<int>(index * 2);
+}
+
+static vector<int> makeIds(size_t n, bool shuffled, mt19937_64& rng) {
+    vector<int> ids(n);
+    for (size_t i = 0; i < n; i++) {
+        ids[i] = idAt(i);
+    }
+    if (shuffled) {
+        shuffle(ids.begin(), ids.end(), rng);
+    }
+    return ids;
+}
+
+// GPAs are uniform over 0.00 - 4.00 in steps of 0.01, so a GPA band of
+// width w matches about w / 4 of the students.
+static RBTree::Student makeStudent(int id, mt19937_64& rng) {
+    string name = string(FIRST_NAMES[rng() % FIRST_NAME_COUNT]) + " " + LAST_NAMES[rng() % LAST_NAME_COUNT];
+    double gpa = static_cast<double>(rng() % 401) / 100.0;
+    return RBTree::Student(id, name, DEPARTMENTS[rng() % DEPARTMENT_COUNT], gpa);
+}
+
+static vector<RBTree::Student> makeStudents(const vector<int>& ids, mt19937_64& rng) {
+    vector<RBTree::Student> students;
+    students.reserve(ids.size());
+    for (int id : ids) {
+        students.push_back(makeStudent(id, rng));
+    }
+    return students;
+}
+
+static vector<RBTree::Student> makeStudents(size_t n, bool shuffled, mt19937_64& rng) {
+    return makeStudents(makeIds(n, shuffled, rng), rng);
+}
+
+static vector<int> uniformQueries(size_t n, size_t count, mt19937_64& rng) {
+    vector<int> queries(count);
+    for (int& id : queries) {
+        id = idAt(rng() % n);
+    }
+    return queries;
+}
+
+// Zipf-distributed ranks in [1, n] with exponent s, by rejection-inversion
+// (Hormann and Derflinger), which needs no table over the n ranks.
+class ZipfSampler {
+    double s;
+    double hIntegralX1;
+    double hIntegralN;
+    double threshold;
+    uniform_real_distribution<double> uniform;
+
+    double h(double x) const { return exp(-s * log(x)); }
+
+    double hIntegral(double x) const {
+        double logX = log(x);
+        return helper2((1.0 - s) * logX) * logX;
+    }
+
+    double hIntegralInverse(double x) const {
+        double t = max(-1.0, x * (1.0 - s));
+        return exp(helper1(t) * x);
+    }
+
+    // log1p(x) / x and expm1(x) / x, stable near 0
+    static double helper1(double x) { return abs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x / 3.0); }
+    static double helper2(double x) { return abs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0); }
+
+public:
+    ZipfSampler(size_t n, double exponent)
+        : s(exponent), uniform(0.0, 1.0) {
+        hIntegralX1 = hIntegral(1.5) - 1.0;
+        hIntegralN = hIntegral(static_cast<double>(n) + 0.5);
+        threshold = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+
+    size_t operator()(mt19937_64& rng) {
+        for (;;) {
+            double u = hIntegralN + uniform(rng) * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            double k = floor(x + 0.5);
+            if (k - x <= threshold || u >= hIntegral(k + 0.5) - h(k)) {
+                return static_cast<size_t>(k);
+            }
+        }
+    }
+};
+
+// Lookups where a few students are hot: rank k of the Zipf distribution is
+// the k-th student of a shuffled order, so the hot IDs are spread out.
+static vector<int> zipfQueries(size_t n, size_t count, mt19937_64& rng) {
+    vector<int> hot = makeIds(n, true, rng);
+    ZipfSampler zipf(n, 0.99);
+    vector<int> queries(count);
+    for (int& id : queries) {
+        id = hot[min(zipf(rng), n) - 1];
+    }
+    return queries;
+}
+
+static string formatNote(double value, const char *unit) {
+    ostringstream out;
+    out << fixed << setprecision(value < 10 ? 2 : 0) << value << " " << unit;
+    return out.str();
+}
+
+// ---- Benchmarks ------------------------------------------------------------
+
+static void benchInsert(size_t n, uint64_t seed, BenchResult& result, bool shuffled) {
+    mt19937_64 rng(seed);
+    vector<RBTree::Student> students = makeStudents(n, shuffled, rng);
+    RBTree tree;
+    timeEach(result, n, [&](size_t i) { tree.insert(students[i]); });
+    result.note = formatNote(tree.memoryUsage().bytesPerStudent(), "B/student");
+}
+
+static void benchBulkLoad(size_t n, uint64_t seed, BenchResult& result, bool shuffled) {
+    mt19937_64 rng(seed);
+    vector<RBTree::Student> students = makeStudents(n, shuffled, rng);
+    RBTree tree;
+    timeBlock(result, n, [&] { tree.bulkLoad(std::move(students)); });
+    result.note = formatNote(tree.memoryUsage().bytesPerStudent(), "B/student");
+}
+
+static void loadTree(RBTree& tree, size_t n, mt19937_64& rng) {
+    tree.bulkLoad(makeStudents(n, true, rng));
+}
+
+static void benchFind(size_t n, uint64_t seed, BenchResult& result, const string& pattern) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    vector<int> queries = pattern == "zipf" ? zipfQueries(n, n, rng) : uniformQueries(n, n, rng);
+    if (pattern == "miss") {
+        for (int& id : queries) {
+            id++;
+        }
+    }
+    size_t found = 0;
+    timeEach(result, n, [&](size_t i) { found += tree.find(queries[i]) != tree.end(); });
+    sink = found;
+    result.note = formatNote(100.0 * static_cast<double>(found) / static_cast<double>(n), "% hits");
+}
+
+static void benchSelect(size_t n, uint64_t seed, BenchResult& result) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    vector<size_t> positions(n);
+    for (size_t& k : positions) {
+        k = rng() % n;
+    }
+    size_t total = 0;
+    timeEach(result, n, [&](size_t i) { total += static_cast<size_t>(tree.select(positions[i])->getId()); });
+    sink = total;
+}
+
+static void benchDelete(size_t n, uint64_t seed, BenchResult& result) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    vector<int> order = makeIds(n, true, rng);
+    timeEach(result, n, [&](size_t i) { tree.deleteNode(order[i]); });
+}
+
+// readPercent of the operations are uniform finds; the rest alternate
+// between deleting a present student and inserting a missing one, so the
+// tree stays at n students.
+static void benchMixed(size_t n, uint64_t seed, BenchResult& result, unsigned readPercent) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    vector<int> queries = uniformQueries(n, n, rng);
+    vector<bool> isRead(n);
+    for (size_t i = 0; i < n; i++) {
+        isRead[i] = rng() % 100 < readPercent;
+    }
+    vector<RBTree::Student> fresh;
+    fresh.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!isRead[i]) {
+            fresh.push_back(makeStudent(idAt(n + i), rng));
+        }
+    }
+    vector<int> victims = makeIds(n, true, rng);
+
+    size_t found = 0;
+    size_t nextWrite = 0;
+    size_t nextVictim = 0;
+    timeEach(result, n, [&](size_t i) {
+        if (isRead[i]) {
+            found += tree.find(queries[i]) != tree.end();
+        } else if (nextWrite++ % 2 == 0) {
+            tree.deleteNode(victims[nextVictim++]);
+        } else {
+            tree.insert(fresh[nextWrite / 2 - 1]);
+        }
+    });
+    sink = found;
+}
+
+// Each scan visits every student in a random window of width IDs.
+static void benchRange(size_t n, uint64_t seed, BenchResult& result, size_t width) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    size_t scans = min<size_t>(100000, max<size_t>(100, 10 * n / width));
+    vector<int> starts = uniformQueries(n, scans, rng);
+    size_t rows = 0;
+    timeEach(result, scans, [&](size_t i) {
+        tree.forEachInRange(starts[i], starts[i] + static_cast<int>(width) - 1,
+                            [&](const RBTree::StudentView&) { rows++; });
+    });
+    sink = rows;
+    result.note = formatNote(static_cast<double>(rows) / static_cast<double>(scans), "rows/scan");
+}
+
+// countRange and rangeStats answer from subtree summaries whatever the width.
+static void benchRangeSummary(size_t n, uint64_t seed, BenchResult& result, bool stats) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    vector<int> starts = uniformQueries(n, n, rng);
+    int width = static_cast<int>(min<size_t>(n, 100000));
+    double total = 0;
+    timeEach(result, n, [&](size_t i) {
+        if (stats) {
+            total += tree.rangeStats(starts[i], starts[i] + width).mean();
+        } else {
+            total += static_cast<double>(tree.countRange(starts[i], starts[i] + width));
+        }
+    });
+    sink = static_cast<size_t>(total);
+}
+
+// A full walk, in ID order or pre-order. A bulk-loaded tree has its nodes in
+// ID order in memory; a tree built by random inserts does not.
+static void benchTraverse(size_t n, uint64_t seed, BenchResult& result, bool preOrder, bool inserted) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    if (inserted) {
+        for (const RBTree::Student& student : makeStudents(n, true, rng)) {
+            tree.insert(student);
+        }
+    } else {
+        loadTree(tree, n, rng);
+    }
+    size_t walks = max<size_t>(3, 10000000 / n);
+    double total = 0;
+    timeEach(result, walks, [&](size_t) {
+        if (preOrder) {
+            tree.forEachPreOrder([&](const RBTree::Node *node, int) { total += tree.getStudent(node).getGpa(); });
+        } else {
+            tree.forEach([&](const RBTree::StudentView& student) { total += student.getGpa(); });
+        }
+    });
+    sink = static_cast<size_t>(total);
+    result.note = formatNote(static_cast<double>(n * walks) / result.seconds / 1e6, "M students/s");
+}
+
+static void benchGpa(size_t n, uint64_t seed, BenchResult& result, const string& query) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    size_t queries = query == "percentile" ? n : 1000;
+    vector<double> lows(queries);
+    for (double& lo : lows) {
+        lo = static_cast<double>(rng() % 397) / 100.0;
+    }
+    size_t rows = 0;
+    timeEach(result, queries, [&](size_t i) {
+        if (query == "top100") {
+            rows += tree.topK(100).size();
+        } else if (query == "band") {
+            rows += tree.gpaRange(lows[i], lows[i] + 0.03).size();     // 4 steps, about 1%
+        } else {
+            rows += static_cast<size_t>(tree.percentile(lows[i] * 25.0));
+        }
+    });
+    sink = rows;
+    if (query != "percentile") {
+        result.note = formatNote(static_cast<double>(rows) / static_cast<double>(queries), "rows/query");
+    }
+}
+
+static void benchDepartment(size_t n, uint64_t seed, BenchResult& result) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    size_t rosters = max<size_t>(DEPARTMENT_COUNT, 1000000 / n);
+    size_t rows = 0;
+    double total = 0;
+    timeEach(result, rosters, [&](size_t i) {
+        tree.forEachInDepartment(DEPARTMENTS[i % DEPARTMENT_COUNT], [&](const RBTree::StudentView& student) {
+            total += student.getGpa();
+            rows++;
+        });
+    });
+    sink = static_cast<size_t>(total);
+    result.note = formatNote(static_cast<double>(rows) / static_cast<double>(rosters), "rows/roster");
+}
+
+// Name searches the way the GUI runs them: three typed letters, at most
+// 500 matches.
+static void benchNameSearch(size_t n, uint64_t seed, BenchResult& result, bool prefix) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    size_t queries = 10000;
+    vector<string> texts(queries);
+    for (string& text : texts) {
+        string name = string(FIRST_NAMES[rng() % FIRST_NAME_COUNT]) + " " + LAST_NAMES[rng() % LAST_NAME_COUNT];
+        size_t start = prefix ? (rng() % 2 == 0 ? 0 : name.find(' ') + 1) : rng() % (name.size() - 2);
+        text = name.substr(start, 3);
+    }
+    size_t rows = 0;
+    timeEach(result, queries, [&](size_t i) {
+        rows += prefix ? tree.searchNamePrefix(texts[i], 500).size()
+                       : tree.searchNameContaining(texts[i], 500).size();
+    });
+    sink = rows;
+    result.note = formatNote(static_cast<double>(rows) / static_cast<double>(queries), "rows/query");
+}
+
+static size_t countBits(const vector<uint64_t>& bitmap) {
+    size_t count = 0;
+    for (uint64_t word : bitmap) {
+        count += static_cast<size_t>(popcount(word));
+    }
+    return count;
+}
+
+// Filter scans over a ColumnSnapshot with one kernel, or (kernel < 0) the
+// same filter as a walk over the tree for comparison. A department adds a
+// 1-in-12 equality test to the GPA band.
+static void benchFilter(size_t n, uint64_t seed, BenchResult& result, int kernel,
+                        unsigned percent, bool byDepartment) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    ColumnSnapshot columns(tree);
+    ColumnSnapshot::Filter filter{true, 0, 0.0, 4.0 * percent / 100.0};
+    if (byDepartment) {
+        filter.anyDepartment = false;
+        filter.deptCode = tree.getDepartmentIndex().findCode(DEPARTMENTS[0]);
+    }
+
+    size_t scans = max<size_t>(5, 50000000 / n);
+    size_t matches = 0;
+    timeEach(result, scans, [&](size_t) {
+        if (kernel >= 0) {
+            matches = countBits(columns.matchBitmap(filter, static_cast<ScanKernel>(kernel)));
+            return;
+        }
+        matches = 0;
+        tree.forEach([&](const RBTree::StudentView& student) {
+            matches += (filter.anyDepartment || student.getDeptCode() == filter.deptCode) &&
+                       student.getGpa() >= filter.minGpa && student.getGpa() <= filter.maxGpa;
+        });
+    });
+    sink = matches;
+    double rowsPerSecond = static_cast<double>(n * scans) / result.seconds;
+    result.note = formatNote(rowsPerSecond / 1e6, "M rows/s") + ", " +
+                  formatNote(100.0 * static_cast<double>(matches) / static_cast<double>(n), "% match");
+}
+
+static void benchStorage(size_t n, uint64_t seed, BenchResult& result, StorageEngine engine,
+                         const string& operation) {
+    mt19937_64 rng(seed);
+    unique_ptr<StudentStorage> storage = StudentStorage::create(engine);
+    vector<RBTree::Student> students = makeStudents(n, true, rng);
+
+    if (operation == "insert_random") {
+        timeEach(result, n, [&](size_t i) { storage->insert(std::move(students[i])); });
+        return;
+    }
+    if (operation == "bulk_load") {
+        timeBlock(result, n, [&] { storage->bulkLoad(std::move(students)); });
+        return;
+    }
+
+    storage->bulkLoad(std::move(students));
+    size_t rows = 0;
+    if (operation == "find_uniform") {
+        vector<int> queries = uniformQueries(n, n, rng);
+        timeEach(result, n, [&](size_t i) { rows += storage->find(queries[i]).has_value(); });
+    } else {
+        size_t scans = min<size_t>(100000, max<size_t>(100, n / 100));
+        vector<int> starts = uniformQueries(n, scans, rng);
+        timeEach(result, scans, [&](size_t i) {
+            storage->forEachInRange(starts[i], starts[i] + 999, [&](const RBTree::StudentView&) { rows++; });
+        });
+    }
+    sink = rows;
+}
+
+// Readers looking up uniform IDs in parallel through the read lock; the
+// total throughput shows how reads scale with threads.
+static void benchConcurrentReads(size_t n, uint64_t seed, BenchResult& result, unsigned threads) {
+    mt19937_64 rng(seed);
+    ConcurrentRBTree tree;
+    tree.bulkLoad(makeStudents(n, true, rng));
+    vector<vector<int>> queries(threads);
+    vector<vector<uint32_t>> latencies(threads);
+    for (unsigned t = 0; t < threads; t++) {
+        queries[t] = uniformQueries(n, n, rng);
+        latencies[t].reserve(n);
+    }
+
+    // Timing starts once every reader is up, so thread creation is not
+    // counted
+    atomic<unsigned> ready(0);
+    atomic<bool> go(false);
+    atomic<size_t> found(0);
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load()) {
+                this_thread::yield();
+            }
+            size_t local = 0;
+            recordEach(latencies[t], n, [&](size_t i) { local += tree.contains(queries[t][i]); });
+            found.fetch_add(local);
+        });
+    }
+    while (ready.load() < threads) {
+        this_thread::yield();
+    }
+    uint64_t allocations = allocationCount.load();
+    Clock::time_point start = Clock::now();
+    go.store(true);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    result.seconds = chrono::duration<double>(Clock::now() - start).count();
+    result.allocations = allocationCount.load() - allocations;
+    result.ops = n * threads;
+    sink = found.load();
+
+    result.latencies.reserve(result.ops);
+    for (const vector<uint32_t>& part : latencies) {
+        result.latencies.insert(result.latencies.end(), part.begin(), part.end());
+    }
+}
+
+static filesystem::path benchFile(const char *name) {
+    return filesystem::temp_directory_path() / ("student_records_bench_" + to_string(Clock::now().time_since_epoch().count()) + "_" + name);
+}
+
+static void benchPersist(size_t n, uint64_t seed, BenchResult& result, const string& operation) {
+    mt19937_64 rng(seed);
+    RBTree tree;
+    loadTree(tree, n, rng);
+    filesystem::path path = benchFile(operation == "csv_import" ? "import.csv" : "students.snap");
+    string error;
+    bool ok = true;
+
+    if (operation == "snapshot_save") {
+        timeBlock(result, n, [&] { ok = Snapshot::save(tree, path.string(), &error); });
+    } else if (operation == "snapshot_load") {
+        ok = Snapshot::save(tree, path.string(), &error);
+        RBTree loaded;
+        timeBlock(result, n, [&] {
+            Snapshot snapshot;
+            ok = ok && snapshot.open(path.string(), true, &error);
+            if (ok) {
+                snapshot.loadInto(loaded);
+            }
+        });
+    } else {
+        {
+            ofstream out(path);
+            out << "id,name,department,gpa\n";
+            tree.forEach([&](const RBTree::StudentView& student) {
+                out << student.getId() << "," << student.getName() << "," << student.getDept() << ","
+                    << fixed << setprecision(2) << student.getGpa() << "\n";
+            });
+        }
+        RBTree imported;
+        ImportReport report;
+        timeBlock(result, n, [&] { ok = CsvImporter().importFile(path.string(), imported, report, &error); });
+    }
+
+    error_code ignored;
+    filesystem::remove(path, ignored);
+    result.note = ok ? formatNote(static_cast<double>(n) / result.seconds / 1e6, "M students/s")
+                     : "failed: " + error;
+}
+
+// ---- Registry and report ---------------------------------------------------
+
+static vector<unsigned> readerCounts(unsigned maxThreads) {
+    vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+static vector<Benchmark> makeBenchmarks(const BenchOptions& options) {
+    vector<Benchmark> benchmarks;
+    auto add = [&](string name, function<void(size_t, uint64_t, BenchResult&)> run) {
+        benchmarks.push_back(Benchmark{std::move(name), std::move(run)});
+    };
+    using namespace placeholders;
+
+    add("insert/sequential", bind(benchInsert, _1, _2, _3, false));
+    add("insert/random", bind(benchInsert, _1, _2, _3, true));
+    add("bulk_load/sorted", bind(benchBulkLoad, _1, _2, _3, false));
+    add("bulk_load/shuffled", bind(benchBulkLoad, _1, _2, _3, true));
+    add("find/uniform", bind(benchFind, _1, _2, _3, string("uniform")));
+    add("find/zipf", bind(benchFind, _1, _2, _3, string("zipf")));
+    add("find/miss", bind(benchFind, _1, _2, _3, string("miss")));
+    add("select/uniform", benchSelect);
+    add("delete/random", benchDelete);
+    add("mixed/read95", bind(benchMixed, _1, _2, _3, 95u));
+    add("mixed/read50", bind(benchMixed, _1, _2, _3, 50u));
+    for (size_t width : {size_t(10), size_t(1000), size_t(100000)}) {
+        add("range/width" + to_string(width), bind(benchRange, _1, _2, _3, width));
+    }
+    add("range/count", bind(benchRangeSummary, _1, _2, _3, false));
+    add("range/stats", bind(benchRangeSummary, _1, _2, _3, true));
+    add("traverse/in_order", bind(benchTraverse, _1, _2, _3, false, false));
+    add("traverse/pre_order", bind(benchTraverse, _1, _2, _3, true, false));
+    add("traverse/in_order_inserted", bind(benchTraverse, _1, _2, _3, false, true));
+    add("gpa/top100", bind(benchGpa, _1, _2, _3, string("top100")));
+    add("gpa/band", bind(benchGpa, _1, _2, _3, string("band")));
+    add("gpa/percentile", bind(benchGpa, _1, _2, _3, string("percentile")));
+    add("dept/roster", benchDepartment);
+    add("name/prefix", bind(benchNameSearch, _1, _2, _3, true));
+    add("name/contains", bind(benchNameSearch, _1, _2, _3, false));
+
+    for (unsigned percent : {1u, 10u, 50u}) {
+        string suffix = "/sel" + to_string(percent);
+        add("filter/tree_walk" + suffix, bind(benchFilter, _1, _2, _3, -1, percent, false));
+        for (ScanKernel kernel : {SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2}) {
+            if (ColumnSnapshot::kernelSupported(kernel)) {
+                add(string("filter/") + ColumnSnapshot::kernelName(kernel) + suffix,
+                    bind(benchFilter, _1, _2, _3, int(kernel), percent, false));
+            }
+        }
+    }
+    add(string("filter/") + ColumnSnapshot::kernelName(ColumnSnapshot::bestKernel()) + "/dept_sel10",
+        bind(benchFilter, _1, _2, _3, int(ColumnSnapshot::bestKernel()), 10u, true));
+
+    for (StorageEngine engine : {RBTREE_ENGINE, BPLUS_TREE_ENGINE}) {
+        string prefix = engine == RBTREE_ENGINE ? "storage/rbtree/" : "storage/bptree/";
+        for (const char *operation : {"insert_random", "bulk_load", "find_uniform", "range_width1000"}) {
+            add(prefix + operation, bind(benchStorage, _1, _2, _3, engine, string(operation)));
+        }
+    }
+
+    for (unsigned threads : readerCounts(options.threads)) {
+        add("concurrent/read_x" + to_string(threads), bind(benchConcurrentReads, _1, _2, _3, threads));
+    }
+
+    for (const char *operation : {"snapshot_save", "snapshot_load", "csv_import"}) {
+        add(string("persist/") + operation, bind(benchPersist, _1, _2, _3, string(operation)));
+    }
+    return benchmarks;
+}
+
+static string formatNanos(double ns) {
+    ostringstream out;
+    out << fixed << setprecision(ns < 10000 ? 0 : 1);
+    if (ns < 10000) {
+        out << ns << " ns";
+    } else if (ns < 1e7) {
+        out << ns / 1e3 << " us";
+    } else {
+        out << ns / 1e6 << " ms";
+    }
+    return out.str();
+}
+
+static string formatRate(double perSecond) {
+    ostringstream out;
+    out << fixed << setprecision(2);
+    if (perSecond >= 1e6) {
+        out << perSecond / 1e6 << " M";
+    } else if (perSecond >= 1e3) {
+        out << perSecond / 1e3 << " k";
+    } else {
+        out << perSecond;
+    }
+    return out.str();
+}
+
+// Nearest-rank percentiles of a sorted sample.
+static double percentileOf(const vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size()));
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+static void printHeader(bool csv) {
+    if (csv) {
+        cout << "benchmark,n,ops,seconds,ops_per_sec,p50_ns,p90_ns,p99_ns,max_ns,allocs_per_op,peak_rss_bytes,note\n";
+        return;
+    }
+    cout << left << setw(34) << "benchmark" << right << setw(10) << "n" << setw(12) << "ops/s"
+         << setw(10) << "p50" << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "max"
+         << setw(11) << "allocs/op" << setw(11) << "peak RSS" << "  note\n";
+}
+
+static void printResult(const string& name, size_t n, BenchResult& result, size_t peakRss, bool csv) {
+    sort(result.latencies.begin(), result.latencies.end());
+    bool timed = !result.latencies.empty();
+    double opsPerSecond = result.seconds > 0 ? static_cast<double>(result.ops) / result.seconds : 0;
+    double allocsPerOp = result.ops > 0 ? static_cast<double>(result.allocations) / static_cast<double>(result.ops) : 0;
+    double p50 = percentileOf(result.latencies, 50);
+    double p90 = percentileOf(result.latencies, 90);
+    double p99 = percentileOf(result.latencies, 99);
+    double worst = timed ? result.latencies.back() : 0;
+
+    if (csv) {
+        cout << name << "," << n << "," << result.ops << "," << result.seconds << "," << opsPerSecond << ","
+             << p50 << "," << p90 << "," << p99 << "," << worst << "," << allocsPerOp << ","
+             << peakRss << ",\"" << result.note << "\"" << endl;
+        return;
+    }
+    ostringstream allocs;
+    allocs << fixed << setprecision(allocsPerOp < 10 ? 2 : 0) << allocsPerOp;
+    ostringstream rss;
+    rss << fixed << setprecision(1) << static_cast<double>(peakRss) / (1024.0 * 1024.0) << " MB";
+    string dash = "-";
+    cout << left << setw(34) << name << right << setw(10) << n << setw(12) << formatRate(opsPerSecond)
+         << setw(10) << (timed ? formatNanos(p50) : dash) << setw(10) << (timed ? formatNanos(p90) : dash)
+         << setw(10) << (timed ? formatNanos(p99) : dash) << setw(10) << (timed ? formatNanos(worst) : dash)
+         << setw(11) << allocs.str() << setw(11) << rss.str() << "  " << result.note << endl;
+}
+
+static void printUsage(const char *program) {
+    cout << "Usage: " << program << " [options]\n";
+    cout << "  --size N[,N...]   students per benchmark, K/M suffixes allowed (default: 1M)\n";
+    cout << "  --filter TEXT     run only benchmarks whose name contains TEXT\n";
+    cout << "  --threads N       most reader threads for concurrent/ (default: all cores)\n";
+    cout << "  --seed N          seed for every workload (default: 42)\n";
+    cout << "  --csv             print comma-separated results\n";
+    cout << "  --list            print the benchmark names and exit\n";
+}
+
+static bool parseCount(const string& text, size_t& count) {
+    size_t end = 0;
+    unsigned long long value = 0;
+    try {
+        value = stoull(text, &end);
+    } catch (const exception&) {
+        return false;
+    }
+    string suffix = text.substr(end);
+    if (suffix == "k" || suffix == "K") {
+        value *= 1000;
+    } else if (suffix == "m" || suffix == "M") {
+        value *= 1000000;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--csv") {
+            options.csv = true;
+        } else if (arg == "--list") {
+            options.list = true;
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            options.sizes.clear();
+            stringstream list(argv[++i]);
+            string item;
+            while (getline(list, item, ',')) {
+                size_t size = 0;
+                // IDs go up to 2n, which must fit an int
+                if (!parseCount(item, size) || size == 0 || size > INT_MAX / 2) {
+                    cerr << "Invalid size: " << item << "\n";
+                    return false;
+                }
+                options.sizes.push_back(size);
+            }
+        } else if (arg == "--threads" && hasValue) {
+            size_t threads = 0;
+            if (!parseCount(argv[++i], threads) || threads == 0 || threads > 1024) {
+                cerr << "Invalid thread count: " << argv[i] << "\n";
+                return false;
+            }
+            options.threads = static_cast<unsigned>(threads);
+        } else if (arg == "--seed" && hasValue) {
+            size_t seed = 0;
+            if (!parseCount(argv[++i], seed)) {
+                cerr << "Invalid seed: " << argv[i] << "\n";
+                return false;
+            }
+            options.seed = seed;
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return !options.sizes.empty();
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options{{1000000}, 42, max(1u, thread::hardware_concurrency()), string(), false, false};
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    vector<Benchmark> benchmarks;
+    for (Benchmark& benchmark : makeBenchmarks(options)) {
+        if (benchmark.name.find(options.filter) != string::npos) {
+            benchmarks.push_back(std::move(benchmark));
+        }
+    }
+    if (options.list) {
+        for (const Benchmark& benchmark : benchmarks) {
+            cout << benchmark.name << "\n";
+        }
+        return 0;
+    }
+
+    if (!options.csv) {
+#if defined(__GNUC__) && !defined(__OPTIMIZE__)
+        cout << "Warning: built without optimization; configure with -DCMAKE_BUILD_TYPE=Release\n";
+#endif
+        cout << "seed " << options.seed << ", " << options.threads << " threads, peak RSS "
+#ifdef __linux__
+             << "per benchmark\n\n";
+#else
+             << "for the whole run\n\n";
+#endif
+    }
+    printHeader(options.csv);
+    for (size_t n : options.sizes) {
+        for (const Benchmark& benchmark : benchmarks) {
+            BenchResult result;
+            resetPeakRss();
+            benchmark.run(n, options.seed, result);
+            printResult(benchmark.name, n, result, peakRssBytes(), options.csv);
+        }
+    }
+    return 0;
+}
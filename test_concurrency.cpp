@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentRBTree.h"
+
+using namespace std;
+
+// Stress test for ConcurrentRBTree: two writers insert, delete and update
+// odd IDs (one takes IDs that are 1 mod 4, the other 3 mod 4) while readers
+// search, scan ranges and walk the tree. Even IDs are loaded up front and
+// never change, so every reader knows what it must see; odd IDs come and go
+// but always carry their own name and one of two GPAs. validate() is run under
+// the read lock as the writers go, and the final tree must equal what the
+// writers think they left.
+
+namespace {
+
+const int STABLE_STUDENTS = 20000;          // IDs 0, 2, ..., 39998
+const int ID_SPAN = 2 * STABLE_STUDENTS;
+const int WRITES_PER_WRITER = 60000;
+
+atomic<int> failures(0);
+mutex reportLock;
+unsigned runSeed = 0;
+
+// The seed fixes each thread's choices, not how the threads interleave.
+void fail(const string& message) {
+    if (failures.fetch_add(1) < 10) {
+        lock_guard<mutex> guard(reportLock);
+        cerr << "seed " << runSeed << ": " << message << "\n";
+    }
+}
+
+string nameFor(int id) {
+    return "Student " + to_string(id);
+}
+
+double gpaFor(int id) {
+    return (id % 401) / 100.0;
+}
+
+double updatedGpaFor(int id) {
+    return 4.0 - gpaFor(id);
+}
+
+bool isExpected(int id, string_view name, double gpa) {
+    if (name != nameFor(id)) {
+        return false;
+    }
+    return gpa == gpaFor(id) || (id % 2 == 1 && gpa == updatedGpaFor(id));
+}
+
+void runWriter(ConcurrentRBTree& tree, int residue, unsigned seed, set<int>& present) {
+    mt19937 rng(seed);
+    for (int i = 0; i < WRITES_PER_WRITER; i++) {
+        int id = static_cast<int>(rng() % (ID_SPAN / 4)) * 4 + residue;
+        bool wasPresent = present.count(id) > 0;
+        unsigned action = rng() % 4;
+        if (action == 0 && wasPresent) {
+            bool updated = tree.write([id](RBTree& t) { return t.updateGpa(id, updatedGpaFor(id)); });
+            if (!updated) {
+                fail("updateGpa(" + to_string(id) + ") missed a student the writer inserted");
+            }
+        } else if (action <= 1 && wasPresent) {
+            if (!tree.deleteNode(id)) {
+                fail("deleteNode(" + to_string(id) + ") missed a student the writer inserted");
+            }
+            present.erase(id);
+        } else {
+            if (tree.insert(id, nameFor(id), id % 8 < 4 ? "CS" : "EE", gpaFor(id)) == wasPresent) {
+                fail("insert(" + to_string(id) + ") disagreed with the writer's own record");
+            }
+            present.insert(id);
+        }
+    }
+}
+
+void checkRange(const ConcurrentRBTree& tree, int lo, int hi) {
+    vector<RBTree::Student> rows = tree.rangeQuery(lo, hi);
+    int stableSeen = 0;
+    int previous = INT_MIN;
+    for (const RBTree::Student& student : rows) {
+        int id = student.getId();
+        if (id < lo || id > hi || id <= previous) {
+            fail("rangeQuery(" + to_string(lo) + ", " + to_string(hi) + ") returned " +
+                 to_string(id) + " out of range or out of order");
+            return;
+        }
+        if (!isExpected(id, student.getName(), student.getGpa())) {
+            fail("rangeQuery returned a torn student " + to_string(id));
+        }
+        stableSeen += id % 2 == 0 ? 1 : 0;
+        previous = id;
+    }
+    int firstEven = max(0, lo + (lo % 2 != 0 ? 1 : 0));
+    int lastEven = min(ID_SPAN - 2, hi);
+    int expectedStable = lastEven < firstEven ? 0 : (lastEven - firstEven) / 2 + 1;
+    if (stableSeen != expectedStable) {
+        fail("rangeQuery(" + to_string(lo) + ", " + to_string(hi) + ") saw " + to_string(stableSeen) +
+             " of " + to_string(expectedStable) + " unchanging students");
+    }
+}
+
+// Under one read lock the tree must hold still: the version must not move,
+// and the counts from size(), countRange(), rank() and a full walk agree.
+void checkSnapshot(const ConcurrentRBTree& tree, bool validate) {
+    bool consistent = tree.read([&tree, validate](const RBTree& t) {
+        uint64_t before = tree.version();
+        size_t walked = 0;
+        for (RBTree::StudentView student : t) {
+            (void)student;
+            walked++;
+        }
+        bool ok = walked == t.size() && t.countRange(INT_MIN, INT_MAX) == t.size()
+               && t.rank(ID_SPAN) == t.size() && (!validate || t.validate());
+        return ok && tree.version() == before;
+    });
+    if (!consistent) {
+        fail("tree changed or failed validate() while a read lock was held");
+    }
+}
+
+void runReader(const ConcurrentRBTree& tree, unsigned seed, const atomic<bool>& done) {
+    mt19937 rng(seed);
+    long long rounds = 0;
+    while (!done.load()) {
+        int even = static_cast<int>(rng() % STABLE_STUDENTS) * 2;
+        optional<RBTree::Student> found = tree.find(even);
+        if (!found || !isExpected(even, found->getName(), found->getGpa())) {
+            fail("find(" + to_string(even) + ") lost or tore an unchanging student");
+        }
+        int odd = even + 1;
+        found = tree.find(odd);
+        if (found && !isExpected(odd, found->getName(), found->getGpa())) {
+            fail("find(" + to_string(odd) + ") returned a torn student");
+        }
+        if (!tree.contains(even)) {
+            fail("contains(" + to_string(even) + ") lost an unchanging student");
+        }
+
+        int lo = static_cast<int>(rng() % ID_SPAN) - 10;
+        checkRange(tree, lo, lo + static_cast<int>(rng() % 200));
+
+        if (rounds % 64 == 0) {
+            checkSnapshot(tree, rounds % 1024 == 0);
+        }
+        rounds++;
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(strtoul(argv[1], nullptr, 10)) : random_device()();
+    runSeed = seed;
+    unsigned readerCount = clamp(thread::hardware_concurrency(), 2u, 8u);
+
+    ConcurrentRBTree tree;
+    vector<RBTree::Student> stable;
+    for (int id = 0; id < ID_SPAN; id += 2) {
+        stable.emplace_back(id, nameFor(id), id % 8 < 4 ? "CS" : "EE", gpaFor(id));
+    }
+    tree.bulkLoad(std::move(stable));
+
+    atomic<bool> done(false);
+    vector<thread> readers;
+    for (unsigned r = 0; r < readerCount; r++) {
+        readers.emplace_back(runReader, cref(tree), seed + 100 + r, cref(done));
+    }
+    set<int> presentA, presentB;
+    thread writerA(runWriter, ref(tree), 1, seed + 1, ref(presentA));
+    thread writerB(runWriter, ref(tree), 3, seed + 2, ref(presentB));
+    writerA.join();
+    writerB.join();
+    done = true;
+    for (thread& reader : readers) {
+        reader.join();
+    }
+
+    bool valid = tree.read([](const RBTree& t) { return t.validate(); });
+    if (!valid) {
+        fail("final tree fails validate()");
+    }
+    size_t expectedSize = size_t(STABLE_STUDENTS) + presentA.size() + presentB.size();
+    if (tree.size() != expectedSize) {
+        fail("final size " + to_string(tree.size()) + ", expected " + to_string(expectedSize));
+    }
+    tree.forEach([&presentA, &presentB](const RBTree::StudentView& student) {
+        int id = student.getId();
+        bool known = id % 2 == 0 || presentA.count(id) > 0 || presentB.count(id) > 0;
+        if (!known || !isExpected(id, student.getName(), student.getGpa())) {
+            fail("final tree holds an unexpected student " + to_string(id));
+        }
+    });
+
+    cout << readerCount << " readers, 2 writers: " << failures.load() << " failures (seed " << seed << ")\n";
+    return failures.load() == 0 ? 0 : 1;
+}
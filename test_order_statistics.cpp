@@ -0,0 +1,203 @@
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <random>
+#include <string>
+#include <vector>
+#include "RBTree.h"
+
+using namespace std;
+
+// Randomized test of the subtree augmentation: rank(), select(),
+// countRange() and rangeStats() are compared against brute-force answers
+// from a std::map while random inserts, deletes, GPA updates and bulk
+// loads reshape the tree. IDs come from a small span so that duplicates,
+// misses and empty ranges are common.
+
+namespace {
+
+const int ROUNDS = 40;
+const int OPERATIONS_PER_ROUND = 2500;
+const int QUERIES_PER_CHECK = 40;
+const int CHECK_EVERY = 250;
+const int ID_SPAN = 3000;
+
+int failures = 0;
+unsigned runSeed = 0;
+int currentRound = 0;
+
+void fail(const string& message) {
+    if (++failures <= 10) {
+        cerr << "seed " << runSeed << ", round " << currentRound << ": " << message << "\n";
+    }
+}
+
+bool nearlyEqual(double actual, double expected) {
+    return fabs(actual - expected) <= 1e-9 * max(1.0, fabs(expected));
+}
+
+double randomGpa(mt19937& rng) {
+    return static_cast<int>(rng() % 401) / 100.0;
+}
+
+int randomId(mt19937& rng) {
+    return static_cast<int>(rng() % ID_SPAN) - ID_SPAN / 2;
+}
+
+void checkQueries(const RBTree& tree, const map<int, double>& model, mt19937& rng) {
+    if (!tree.validate()) {
+        fail("validate() failed");
+    }
+    if (tree.size() != model.size()) {
+        fail("size " + to_string(tree.size()) + ", expected " + to_string(model.size()));
+        return;
+    }
+
+    for (int q = 0; q < QUERIES_PER_CHECK; q++) {
+        int id = randomId(rng);
+        size_t expectedRank = size_t(distance(model.begin(), model.lower_bound(id)));
+        if (tree.rank(id) != expectedRank) {
+            fail("rank(" + to_string(id) + ") = " + to_string(tree.rank(id)) +
+                 ", expected " + to_string(expectedRank));
+        }
+
+        size_t k = rng() % (model.size() + 2);
+        RBTree::const_iterator selected = tree.select(k);
+        if (k >= model.size()) {
+            if (selected != tree.end()) {
+                fail("select(" + to_string(k) + ") past the end did not return end()");
+            }
+        } else if (selected == tree.end() || selected->getId() != next(model.begin(), long(k))->first) {
+            fail("select(" + to_string(k) + ") returned the wrong student");
+        }
+
+        int lo = randomId(rng);
+        int hi = q % 8 == 0 ? lo - 1 - static_cast<int>(rng() % 5) : lo + static_cast<int>(rng() % 600);
+        if (q % 16 == 1) {
+            lo = INT_MIN;
+        } else if (q % 16 == 2) {
+            hi = INT_MAX;
+        }
+
+        vector<double> gpas;
+        if (lo <= hi) {
+            for (auto it = model.lower_bound(lo); it != model.end() && it->first <= hi; ++it) {
+                gpas.push_back(it->second);
+            }
+        }
+        double sum = 0.0, minGpa = INFINITY, maxGpa = -INFINITY;
+        for (double gpa : gpas) {
+            sum += gpa;
+            minGpa = min(minGpa, gpa);
+            maxGpa = max(maxGpa, gpa);
+        }
+        double mean = gpas.empty() ? 0.0 : sum / double(gpas.size());
+        double squares = 0.0;
+        for (double gpa : gpas) {
+            squares += (gpa - mean) * (gpa - mean);
+        }
+        double stddev = gpas.empty() ? 0.0 : sqrt(squares / double(gpas.size()));
+
+        string range = "[" + to_string(lo) + ", " + to_string(hi) + "]";
+        if (tree.countRange(lo, hi) != gpas.size()) {
+            fail("countRange" + range + " = " + to_string(tree.countRange(lo, hi)) +
+                 ", expected " + to_string(gpas.size()));
+        }
+        RBTree::GpaStats stats = tree.rangeStats(lo, hi);
+        if (stats.count != gpas.size()) {
+            fail("rangeStats" + range + " counted " + to_string(stats.count) +
+                 ", expected " + to_string(gpas.size()));
+        } else if (!gpas.empty()
+                   && (stats.min != minGpa || stats.max != maxGpa || !nearlyEqual(stats.mean(), mean)
+                       || fabs(stats.stddev() - stddev) > 1e-6)) {
+            fail("rangeStats" + range + " disagrees with a scan: mean " + to_string(stats.mean()) +
+                 " vs " + to_string(mean) + ", stddev " + to_string(stats.stddev()) + " vs " +
+                 to_string(stddev) + ", min " + to_string(stats.min) + " vs " + to_string(minGpa) +
+                 ", max " + to_string(stats.max) + " vs " + to_string(maxGpa));
+        }
+    }
+}
+
+void runRound(mt19937& rng) {
+    RBTree tree;
+    map<int, double> model;
+
+    // Half the rounds start from a bulk-loaded tree, whose node colours and
+    // subtree summaries are built without any insert fix-ups. A few records
+    // carry a GPA bulkLoad must drop and report.
+    if (rng() % 2 == 0) {
+        vector<RBTree::Student> students;
+        multiset<int> badIds;
+        size_t count = rng() % 1500;
+        for (size_t i = 0; i < count; i++) {
+            int id = randomId(rng);
+            if (rng() % 50 == 0) {
+                students.emplace_back(id, "Student " + to_string(id), "CS", i % 2 == 0 ? NAN : 4.5);
+                badIds.insert(id);
+                continue;
+            }
+            double gpa = randomGpa(rng);
+            students.emplace_back(id, "Student " + to_string(id), "CS", gpa);
+            model.emplace(id, gpa);
+        }
+        // The row overload gets the records unsorted, as they were made.
+        vector<int> invalid;
+        if (rng() % 2 == 0) {
+            tree.bulkLoad(std::move(students), nullptr, &invalid);
+        } else {
+            tree.bulkLoad(students.size(), [&students](size_t k) { return RBTree::StudentView(students[k]); },
+                          nullptr, &invalid);
+        }
+        if (multiset<int>(invalid.begin(), invalid.end()) != badIds) {
+            fail("bulkLoad reported " + to_string(invalid.size()) + " invalid GPAs, expected " +
+                 to_string(badIds.size()));
+        }
+    }
+    checkQueries(tree, model, rng);
+
+    for (int i = 1; i <= OPERATIONS_PER_ROUND; i++) {
+        int id = randomId(rng);
+        unsigned action = rng() % 10;
+        if (action < 5) {
+            double gpa = randomGpa(rng);
+            bool inserted = tree.insert(id, "Student " + to_string(id), "EE", gpa);
+            if (inserted != model.emplace(id, gpa).second) {
+                fail("insert(" + to_string(id) + ") disagreed with std::map");
+            }
+        } else if (action < 8) {
+            if (tree.deleteNode(id) != (model.erase(id) > 0)) {
+                fail("deleteNode(" + to_string(id) + ") disagreed with std::map");
+            }
+        } else {
+            double gpa = randomGpa(rng);
+            auto it = model.find(id);
+            if (tree.updateGpa(id, gpa) != (it != model.end())) {
+                fail("updateGpa(" + to_string(id) + ") disagreed with std::map");
+            }
+            if (it != model.end()) {
+                it->second = gpa;
+            }
+        }
+        if (i % CHECK_EVERY == 0) {
+            checkQueries(tree, model, rng);
+        }
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(strtoul(argv[1], nullptr, 10)) : random_device()();
+    runSeed = seed;
+    mt19937 rng(seed);
+    for (currentRound = 0; currentRound < ROUNDS; currentRound++) {
+        runRound(rng);
+    }
+    cout << ROUNDS << " rounds of " << OPERATIONS_PER_ROUND << " operations: " << failures
+         << " failures (seed " << seed << ")\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "StudentStorage.h"
+
+using namespace std;
+
+// Randomized test of the StudentStorage interface: both engines run the
+// same inserts, deletes, bulk loads and range scans as a std::map and must
+// agree with it. Some records carry a GPA that is NaN or out of range,
+// which insert() must refuse and bulkLoad() must drop and report.
+
+namespace {
+
+const int ROUNDS = 20;
+const int OPERATIONS_PER_ROUND = 3000;
+const int CHECK_EVERY = 300;
+const int ID_SPAN = 4000;
+
+int failures = 0;
+unsigned runSeed = 0;
+
+void fail(const string& message) {
+    if (++failures <= 10) {
+        cerr << "seed " << runSeed << ", " << message << "\n";
+    }
+}
+
+int randomId(mt19937& rng) {
+    return static_cast<int>(rng() % ID_SPAN) - ID_SPAN / 2;
+}
+
+// One GPA in 40 is invalid.
+double randomGpa(mt19937& rng) {
+    switch (rng() % 40) {
+    case 0:
+        return NAN;
+    case 1:
+        return rng() % 2 == 0 ? -0.5 : 4.01;
+    default:
+        return static_cast<int>(rng() % 401) / 100.0;
+    }
+}
+
+RBTree::Student makeStudent(int id, double gpa) {
+    return RBTree::Student(id, "Student " + to_string(id), "CS", gpa);
+}
+
+void checkContents(const StudentStorage& storage, const map<int, double>& model, mt19937& rng,
+                   const string& where) {
+    if (!storage.validate()) {
+        fail(where + ": validate() failed");
+    }
+    if (storage.size() != model.size()) {
+        fail(where + ": size " + to_string(storage.size()) + ", expected " + to_string(model.size()));
+        return;
+    }
+
+    int id = randomId(rng);
+    optional<RBTree::StudentView> found = storage.find(id);
+    auto it = model.find(id);
+    if (found.has_value() != (it != model.end())
+        || (found.has_value() && found->getGpa() != it->second)) {
+        fail(where + ": find(" + to_string(id) + ") disagrees with std::map");
+    }
+
+    int lo = randomId(rng);
+    int hi = rng() % 8 == 0 ? INT_MAX : lo + static_cast<int>(rng() % 800);
+    vector<int> scanned;
+    storage.forEachInRange(lo, hi, [&](const RBTree::StudentView& student) {
+        scanned.push_back(student.getId());
+    });
+    vector<int> expected;
+    for (auto m = model.lower_bound(lo); m != model.end() && m->first <= hi; ++m) {
+        expected.push_back(m->first);
+    }
+    if (scanned != expected) {
+        fail(where + ": forEachInRange[" + to_string(lo) + ", " + to_string(hi) + "] returned " +
+             to_string(scanned.size()) + " students, expected " + to_string(expected.size()));
+    }
+}
+
+void runRound(StorageEngine engine, int round, mt19937& rng) {
+    unique_ptr<StudentStorage> storage = StudentStorage::create(engine);
+    map<int, double> model;
+    string where = string(storage->getEngineName()) + " round " + to_string(round);
+
+    if (rng() % 2 == 0) {
+        vector<RBTree::Student> students;
+        multiset<int> badIds;
+        size_t count = rng() % 2000;
+        for (size_t i = 0; i < count; i++) {
+            int id = randomId(rng);
+            double gpa = randomGpa(rng);
+            students.push_back(makeStudent(id, gpa));
+            if (RBTree::isValidGpa(gpa)) {
+                model.emplace(id, gpa);
+            } else {
+                badIds.insert(id);
+            }
+        }
+        vector<int> invalid;
+        size_t kept = storage->bulkLoad(std::move(students), nullptr, &invalid);
+        if (kept != model.size()) {
+            fail(where + ": bulkLoad kept " + to_string(kept) + ", expected " + to_string(model.size()));
+        }
+        if (multiset<int>(invalid.begin(), invalid.end()) != badIds) {
+            fail(where + ": bulkLoad reported " + to_string(invalid.size()) + " invalid GPAs, expected " +
+                 to_string(badIds.size()));
+        }
+    }
+    checkContents(*storage, model, rng, where);
+
+    for (int i = 1; i <= OPERATIONS_PER_ROUND; i++) {
+        int id = randomId(rng);
+        if (rng() % 3 != 0) {
+            double gpa = randomGpa(rng);
+            bool expected = RBTree::isValidGpa(gpa) && model.emplace(id, gpa).second;
+            if (storage->insert(makeStudent(id, gpa)) != expected) {
+                fail(where + ": insert(" + to_string(id) + ", " + to_string(gpa) +
+                     ") disagreed with std::map");
+            }
+        } else if (storage->deleteNode(id) != (model.erase(id) > 0)) {
+            fail(where + ": deleteNode(" + to_string(id) + ") disagreed with std::map");
+        }
+        if (i % CHECK_EVERY == 0) {
+            checkContents(*storage, model, rng, where);
+        }
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(strtoul(argv[1], nullptr, 10)) : random_device()();
+    runSeed = seed;
+    mt19937 rng(seed);
+    for (StorageEngine engine : {RBTREE_ENGINE, BPLUS_TREE_ENGINE}) {
+        for (int round = 0; round < ROUNDS; round++) {
+            runRound(engine, round, rng);
+        }
+    }
+    cout << ROUNDS << " rounds per engine of " << OPERATIONS_PER_ROUND << " operations: " << failures
+         << " failures (seed " << seed << ")\n";
+    return failures == 0 ? 0 : 1;
+}
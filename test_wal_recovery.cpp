@@ -0,0 +1,241 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "DurableStore.h"
+
+using namespace std;
+
+// Crash-injection test for DurableStore: a child process writes a fixed
+// sequence of operations and is killed with SIGKILL at a random moment
+// (sometimes in the middle of a checkpoint); the parent may then add a torn
+// record to the log's tail, as a power cut in the middle of a write would.
+// Reopening must give a valid tree equal to the state after some prefix of
+// the sequence, and that prefix must include everything the child saw
+// sync() or checkpoint() confirm.
+
+namespace {
+
+const int OPERATIONS = 3000;
+const int SYNC_EVERY = 10;
+const int CHECKPOINT_EVERY = 700;
+const int ROUNDS = 24;
+
+unsigned runSeed = 0;
+
+struct Operation {
+    char kind;      // 'i'nsert, 'u'pdate GPA or 'd'elete
+    int id;
+    double gpa;
+};
+
+double gpaFor(int i) {
+    return (i * 37 % 401) / 100.0;
+}
+
+string nameFor(int id) {
+    return "Student " + to_string(id);
+}
+
+// Inserts, then updates the GPA of the student inserted just before,
+// then deletes that student.
+Operation operationAt(int i) {
+    if (i % 5 == 3) {
+        return {'u', i - 1, gpaFor(i)};
+    }
+    if (i % 5 == 4) {
+        return {'d', i - 2, 0.0};
+    }
+    return {'i', i, gpaFor(i)};
+}
+
+void perform(DurableStore& store, const Operation& op) {
+    if (op.kind == 'i') {
+        store.insert(op.id, nameFor(op.id), op.id % 2 == 0 ? "CS" : "EE", op.gpa);
+    } else if (op.kind == 'u') {
+        store.updateGpa(op.id, op.gpa);
+    } else {
+        store.deleteNode(op.id);
+    }
+}
+
+void perform(map<int, double>& model, const Operation& op) {
+    if (op.kind == 'i') {
+        model.emplace(op.id, op.gpa);
+    } else if (op.kind == 'u') {
+        model[op.id] = op.gpa;
+    } else {
+        model.erase(op.id);
+    }
+}
+
+bool matches(const RBTree& tree, const map<int, double>& model) {
+    if (tree.size() != model.size()) {
+        return false;
+    }
+    auto expected = model.begin();
+    for (RBTree::StudentView student : tree) {
+        if (student.getId() != expected->first || student.getGpa() != expected->second
+            || student.getName() != nameFor(student.getId())) {
+            return false;
+        }
+        ++expected;
+    }
+    return true;
+}
+
+// Runs in the child: writes the whole sequence, reporting over the pipe
+// how many operations are known to be on disk.
+[[noreturn]] void runWriter(const string& directory, int reportFd) {
+    DurableStore store;
+    if (!store.open(directory)) {
+        _exit(3);
+    }
+    for (int i = 0; i < OPERATIONS; i++) {
+        perform(store, operationAt(i));
+        int done = i + 1;
+        bool durable = false;
+        if (done % CHECKPOINT_EVERY == 0) {
+            durable = store.checkpoint();
+        } else if (done % SYNC_EVERY == 0) {
+            durable = store.sync();
+        }
+        if (durable && write(reportFd, &done, sizeof(done)) != sizeof(done)) {
+            _exit(4);
+        }
+    }
+    _exit(0);
+}
+
+// Appends the start of a record that claims more payload than follows.
+void tearTail(const string& walPath, mt19937& rng) {
+    ofstream out(walPath, ios::binary | ios::app);
+    uint32_t length = 64;
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    int extra = static_cast<int>(rng() % 24);
+    for (int i = 0; i < extra; i++) {
+        out.put(static_cast<char>(rng()));
+    }
+}
+
+// Starts a failure message on stderr. The seed replays the run's choices,
+// though not the kill timing, which depends on the machine.
+ostream& roundError(int round) {
+    return cerr << "seed " << runSeed << ", round " << round << ": ";
+}
+
+bool runRound(int round, const filesystem::path& directory, mt19937& rng) {
+    filesystem::remove_all(directory);
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) {
+        roundError(round) << "pipe failed\n";
+        return false;
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        close(pipeFds[0]);
+        runWriter(directory.string(), pipeFds[1]);
+    }
+    close(pipeFds[1]);
+    if (child < 0) {
+        close(pipeFds[0]);
+        roundError(round) << "fork failed\n";
+        return false;
+    }
+
+    usleep(static_cast<useconds_t>(rng() % 60000));
+    kill(child, SIGKILL);
+    int status;
+    waitpid(child, &status, 0);
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+        close(pipeFds[0]);
+        roundError(round) << "writer failed with status " << WEXITSTATUS(status) << "\n";
+        return false;
+    }
+
+    int durable = 0;
+    int done;
+    while (read(pipeFds[0], &done, sizeof(done)) == sizeof(done)) {
+        durable = done;
+    }
+    close(pipeFds[0]);
+
+    string walPath = (directory / "students.wal").string();
+    if (round % 2 == 1 && filesystem::exists(walPath)) {
+        tearTail(walPath, rng);
+    }
+
+    {
+        DurableStore store;
+        string error;
+        if (!store.open(directory.string(), WalOptions(), &error)) {
+            roundError(round) << "reopen failed: " << error << "\n";
+            return false;
+        }
+        const RBTree& tree = store.getTree();
+        if (!tree.validate()) {
+            roundError(round) << "recovered tree is not a valid red-black tree\n";
+            return false;
+        }
+
+        map<int, double> model;
+        int prefix = -1;
+        for (int k = 0; k <= OPERATIONS; k++) {
+            if (k > 0) {
+                perform(model, operationAt(k - 1));
+            }
+            if (k >= durable && matches(tree, model)) {
+                prefix = k;
+                break;
+            }
+        }
+        if (prefix < 0) {
+            roundError(round) << "recovered " << tree.size()
+                 << " students, which is no prefix of the writes at or after the " << durable
+                 << " confirmed durable\n";
+            return false;
+        }
+
+        // The torn tail must have been cut off so new records are readable.
+        if (!store.insert(-1, nameFor(-1), "CS", 2.5) || !store.sync()) {
+            roundError(round) << "cannot append after recovery\n";
+            return false;
+        }
+    }
+
+    DurableStore store;
+    if (!store.open(directory.string()) || store.getTree().find(-1) == store.getTree().end()) {
+        roundError(round) << "record appended after recovery was lost\n";
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned seed = argc > 1 ? static_cast<unsigned>(strtoul(argv[1], nullptr, 10)) : random_device()();
+    runSeed = seed;
+    mt19937 rng(seed);
+    filesystem::path directory = filesystem::temp_directory_path() /
+                                 ("student_records_wal_test_" + to_string(getpid()));
+
+    int failures = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        if (!runRound(round, directory, rng)) {
+            failures++;
+        }
+    }
+    filesystem::remove_all(directory);
+
+    cout << ROUNDS << " crash rounds, " << failures << " failed (seed " << seed << ")\n";
+    return failures == 0 ? 0 : 1;
+}